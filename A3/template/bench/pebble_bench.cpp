@@ -0,0 +1,106 @@
+// Times the pebble - pebble collision step for growing numbers of pebbles
+//
+// Usage: pebble_bench [pebble counts...], defaults to 1000 10000 100000
+
+#include "pebble_physics.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+namespace
+{
+    const int FRAMES = 60;
+    const float FRAME_MS = 1000.f / 60.f;
+
+    // Screen area per pebble, about the density of a busy game
+    const float AREA_PER_PEBBLE = 2500.f;
+
+    // The O(n^2) loop pebbles used to run, only timed for small counts
+    const size_t MAX_NAIVE_PEBBLES = 10000;
+
+    void spawn(PebbleStore& pebbles, size_t count, std::default_random_engine& rng) {
+        float side = std::sqrt(count * AREA_PER_PEBBLE);
+        std::uniform_real_distribution<float> position(0.f, side);
+        std::uniform_real_distribution<float> velocity(-250.f, 250.f);
+        std::uniform_int_distribution<int> radius(7, 16);
+
+        pebbles.clear();
+        for (size_t i = 0; i < count; ++i) {
+            vec2 pebble_position = {position(rng), position(rng)};
+            vec2 pebble_velocity = {velocity(rng), velocity(rng)};
+            pebbles.add(30000, pebble_position, pebble_velocity, {0.f, 0.f}, (float) radius(rng));
+        }
+    }
+
+    void naive_collide(PebbleStore& pebbles) {
+        for (size_t i = 0; i < pebbles.size(); ++i) {
+            for (size_t j = 0; j < pebbles.size(); ++j) {
+                if (i == j)
+                    continue;
+
+                vec2 delta_pos = sub(pebbles.get_position(i), pebbles.get_position(j));
+                float distance = len(delta_pos);
+                float radii = pebbles.radius[i] + pebbles.radius[j];
+                if (distance > radii || distance <= 0.f)
+                    continue;
+
+                vec2 delta_vel = sub(pebbles.get_velocity(i), pebbles.get_velocity(j));
+                vec2 exchange = mul(delta_pos, dot(delta_vel, delta_pos) / sq_len(delta_pos));
+                pebbles.set_velocity(i, sub(pebbles.get_velocity(i), exchange));
+                pebbles.set_velocity(j, add(pebbles.get_velocity(j), exchange));
+
+                float overlap = radii - distance;
+                pebbles.set_position(i, add(pebbles.get_position(i), mul(normalize(delta_pos), overlap)));
+            }
+        }
+    }
+
+    template <typename Step>
+    double time_frames(PebbleStore& pebbles, int frames, Step step) {
+        double total_ms = 0.0;
+        for (int frame = 0; frame < frames; ++frame) {
+            pebbles.integrate(FRAME_MS, 0.f);
+
+            auto start = Clock::now();
+            step(pebbles);
+            auto end = Clock::now();
+            total_ms += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+        return total_ms / frames;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<size_t> counts;
+    for (int i = 1; i < argc; ++i)
+        counts.push_back((size_t) std::strtoul(argv[i], nullptr, 10));
+    if (counts.empty())
+        counts = {1000, 10000, 100000};
+
+    std::printf("%10s %16s %16s\n", "pebbles", "sweep ms/frame", "naive ms/frame");
+
+    for (size_t count : counts) {
+        std::default_random_engine rng(count);
+        PebbleStore pebbles;
+
+        spawn(pebbles, count, rng);
+        PebbleCollider collider;
+        double sweep_ms = time_frames(pebbles, FRAMES, [&collider](PebbleStore& p) { collider.collide(p); });
+
+        if (count <= MAX_NAIVE_PEBBLES) {
+            spawn(pebbles, count, rng);
+            double naive_ms = time_frames(pebbles, FRAMES / 6, naive_collide);
+            std::printf("%10zu %16.3f %16.3f\n", count, sweep_ms, naive_ms);
+        } else {
+            std::printf("%10zu %16.3f %16s\n", count, sweep_ms, "-");
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,478 @@
+// Microbenchmarks of the math helpers, transforms, collision tests and path planners
+//
+// Usage: salmon_bench [filter], only runs the benchmarks whose name contains filter
+//
+// Each benchmark runs for a list of sizes. Its loop is repeated with growing iteration counts
+// until it lasts MIN_RUN_MS, then the time per operation is printed, an operation being one
+// element of the batch the loop body works on. Entities and GL resources go through the null GL,
+// nothing is drawn.
+
+#include "common.hpp"
+#include "salmon.hpp"
+#include "mesh_file.hpp"
+#include "resource_cache.hpp"
+#include "pebbles.hpp"
+#include "nav_grid.hpp"
+#include "flow_field.hpp"
+#include "pathfinder.hpp"
+#include "fish.hpp"
+#include "sprite_store.hpp"
+#include "pebble_physics.hpp"
+#include "null_gl.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <random>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+namespace
+{
+    const double MIN_RUN_MS = 200.0;
+    const size_t MAX_ITERATIONS = 1000000000;
+
+    const vec2 LEVEL_BOUNDS = {1200.f, 800.f};
+    const float LEVEL_PADDING = 50.f;
+
+    // Written to so the compiler cannot drop the results of a benchmark loop
+    volatile char g_sink;
+
+    template <typename T>
+    void keep(const T& value) {
+        g_sink = *reinterpret_cast<const volatile char*>(&value);
+    }
+
+    // Handed to a benchmark, which does its setup and then loops while keep_running()
+    class Run
+    {
+    public:
+        Run(long size, size_t iterations) :
+            m_size(size), m_iterations(iterations), m_done(0), m_ops_per_iteration(1) {
+        }
+
+        long size() const { return m_size; }
+
+        // Operations done by one pass of the loop, 1 by default
+        void set_ops_per_iteration(size_t ops) { m_ops_per_iteration = ops; }
+
+        // Starts the clock on the first call and stops it after the last iteration
+        bool keep_running() {
+            if (m_done == 0)
+                m_start = Clock::now();
+            if (m_done++ < m_iterations)
+                return true;
+            m_end = Clock::now();
+            return false;
+        }
+
+        double elapsed_ns() const { return std::chrono::duration<double, std::nano>(m_end - m_start).count(); }
+        size_t ops() const { return m_iterations * m_ops_per_iteration; }
+
+    private:
+        long m_size;
+        size_t m_iterations;
+        size_t m_done;
+        size_t m_ops_per_iteration;
+        Clock::time_point m_start;
+        Clock::time_point m_end;
+    };
+
+    struct Benchmark {
+        const char* name;
+        std::vector<long> sizes;
+        std::function<void(Run&)> function;
+    };
+
+    void run_benchmark(const Benchmark& benchmark) {
+        for (long size : benchmark.sizes) {
+            size_t iterations = 1;
+            while (true) {
+                Run run(size, iterations);
+                benchmark.function(run);
+
+                double elapsed_ms = run.elapsed_ns() / 1e6;
+                if (elapsed_ms >= MIN_RUN_MS || iterations >= MAX_ITERATIONS) {
+                    char name[128];
+                    snprintf(name, sizeof(name), "%s/%ld", benchmark.name, size);
+                    std::printf("%-32s %12zu %14.2f\n", name, run.ops(), run.elapsed_ns() / run.ops());
+                    break;
+                }
+
+                // Aims a bit past the minimum time, growing at most tenfold per attempt
+                double scale = elapsed_ms > 0.0 ? 1.4 * MIN_RUN_MS / elapsed_ms : 10.0;
+                scale = std::min(10.0, std::max(2.0, scale));
+                iterations = (size_t) (iterations * scale);
+            }
+        }
+    }
+
+    std::vector<vec2> random_points(size_t count, std::default_random_engine& rng) {
+        std::uniform_real_distribution<float> coordinate(-100.f, 100.f);
+        std::vector<vec2> points(count);
+        for (auto& point : points)
+            point = {coordinate(rng), coordinate(rng)};
+        return points;
+    }
+
+    std::vector<mat3> random_matrices(size_t count, std::default_random_engine& rng) {
+        std::uniform_real_distribution<float> coefficient(-2.f, 2.f);
+        std::vector<mat3> matrices(count);
+        for (auto& m : matrices) {
+            m.c0 = {coefficient(rng), coefficient(rng), coefficient(rng)};
+            m.c1 = {coefficient(rng), coefficient(rng), coefficient(rng)};
+            m.c2 = {coefficient(rng), coefficient(rng), coefficient(rng)};
+        }
+        return matrices;
+    }
+
+    // Gives access to the transform of an entity, the way fish and turtles build theirs
+    struct TransformedEntity : public Entity {
+        void draw(const mat3&) override {}
+
+        const mat3& place(vec2 position, float radians, vec2 scale) {
+            transform.set(position, radians, scale);
+            return transform.out;
+        }
+    };
+
+    void bench_dot(Run& run) {
+        std::default_random_engine rng(1);
+        std::vector<vec2> a = random_points(run.size(), rng);
+        std::vector<vec2> b = random_points(run.size(), rng);
+        run.set_ops_per_iteration(a.size());
+        while (run.keep_running()) {
+            float sum = 0.f;
+            for (size_t i = 0; i < a.size(); ++i)
+                sum += dot(a[i], b[i]);
+            keep(sum);
+        }
+    }
+
+    void bench_normalize(Run& run) {
+        std::default_random_engine rng(2);
+        std::vector<vec2> points = random_points(run.size(), rng);
+        std::vector<vec2> out(points.size());
+        run.set_ops_per_iteration(points.size());
+        while (run.keep_running()) {
+            for (size_t i = 0; i < points.size(); ++i)
+                out[i] = normalize(points[i]);
+            keep(out.back());
+        }
+    }
+
+    void bench_mul_mat3(Run& run) {
+        std::default_random_engine rng(3);
+        std::vector<mat3> a = random_matrices(run.size(), rng);
+        std::vector<mat3> b = random_matrices(run.size(), rng);
+        std::vector<mat3> out(a.size());
+        run.set_ops_per_iteration(a.size());
+        while (run.keep_running()) {
+            for (size_t i = 0; i < a.size(); ++i)
+                out[i] = mul(a[i], b[i]);
+            keep(out.back());
+        }
+    }
+
+    void bench_mul_mat3_vec3(Run& run) {
+        std::default_random_engine rng(4);
+        std::vector<mat3> matrices = random_matrices(run.size(), rng);
+        std::vector<vec2> points = random_points(run.size(), rng);
+        std::vector<vec3> out(matrices.size());
+        run.set_ops_per_iteration(matrices.size());
+        while (run.keep_running()) {
+            for (size_t i = 0; i < matrices.size(); ++i)
+                out[i] = mul(matrices[i], vec3{points[i].x, points[i].y, 1.f});
+            keep(out.back());
+        }
+    }
+
+    void bench_transform(Run& run) {
+        std::default_random_engine rng(5);
+        std::vector<vec2> positions = random_points(run.size(), rng);
+        std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+        std::vector<float> radians(positions.size());
+        for (auto& r : radians)
+            r = angle(rng);
+
+        TransformedEntity entity;
+        run.set_ops_per_iteration(positions.size());
+        while (run.keep_running()) {
+            for (size_t i = 0; i < positions.size(); ++i)
+                keep(entity.place(positions[i], radians[i], {0.4f, 0.4f}));
+        }
+    }
+
+    void bench_transform_points(Run& run) {
+        std::default_random_engine rng(6);
+        std::vector<vec2> points = random_points(run.size(), rng);
+        std::vector<vec2> transformed(points.size());
+        affine2 transform = affine2::from_trs({300.f, 200.f}, 0.7f, {0.4f, 0.4f});
+        run.set_ops_per_iteration(points.size());
+        while (run.keep_running()) {
+            transform_points(transform, points.data(), transformed.data(), points.size());
+            keep(transformed.back());
+        }
+    }
+
+    // A salmon touching the left wall, so the bounding box test passes and the mesh is tested
+    bool init_salmon(ResourceCache& resources, Salmon& salmon) {
+        if (!salmon.init(resources, {LEVEL_PADDING, LEVEL_BOUNDS.x - LEVEL_PADDING},
+                         {LEVEL_PADDING, LEVEL_BOUNDS.y - LEVEL_PADDING})) {
+            fprintf(stderr, "Failed to load the salmon\n");
+            return false;
+        }
+        salmon.move(sub({LEVEL_PADDING + 100.f, 400.f}, salmon.get_position()));
+        salmon.set_rotation(0.3f);
+        return true;
+    }
+
+    void bench_salmon_wall(Run& run) {
+        ResourceCache resources;
+        Salmon salmon;
+        if (!init_salmon(resources, salmon))
+            return;
+
+        run.set_ops_per_iteration((size_t) run.size());
+        while (run.keep_running()) {
+            for (long i = 0; i < run.size(); ++i)
+                keep(salmon.collides_with_wall());
+        }
+        salmon.destroy();
+        resources.destroy();
+    }
+
+    void bench_salmon_corners(Run& run) {
+        ResourceCache resources;
+        Salmon salmon;
+        if (!init_salmon(resources, salmon))
+            return;
+
+        run.set_ops_per_iteration((size_t) run.size());
+        while (run.keep_running()) {
+            for (long i = 0; i < run.size(); ++i) {
+                salmon.calculate_corners();
+                keep(salmon.get_top_left_corner());
+            }
+        }
+        salmon.destroy();
+        resources.destroy();
+    }
+
+    // The salmon mesh as the game used to parse it and as it maps it now
+    void bench_read_text_mesh(Run& run) {
+        std::vector<Vertex> vertices;
+        std::vector<uint16_t> indices;
+        while (run.keep_running()) {
+            read_text_mesh(mesh_path("salmon.mesh"), vertices, indices);
+            keep(vertices.back());
+        }
+    }
+
+    void bench_map_mesh_file(Run& run) {
+        MappedMeshFile file;
+        while (run.keep_running()) {
+            file.open(mesh_path("salmon.smesh"));
+            keep(file.get_vertices()[0]);
+            file.close();
+        }
+    }
+
+    void bench_pebble_is_inside(Run& run) {
+        std::default_random_engine rng(6);
+        std::vector<vec2> points = random_points(run.size(), rng);
+        Pebbles pebbles;
+        run.set_ops_per_iteration(points.size());
+        while (run.keep_running()) {
+            int inside = 0;
+            for (auto& point : points)
+                inside += pebbles.is_inside(point, {-50.f, -50.f}, {60.f, -40.f}, {0.f, 70.f});
+            keep(inside);
+        }
+    }
+
+    void bench_pebble_dist(Run& run) {
+        std::default_random_engine rng(7);
+        std::vector<vec2> points = random_points(run.size(), rng);
+        Pebbles pebbles;
+        run.set_ops_per_iteration(points.size());
+        while (run.keep_running()) {
+            float sum = 0.f;
+            for (auto& point : points)
+                sum += pebbles.dist(point, {-50.f, -50.f}, {60.f, -40.f});
+            keep(sum);
+        }
+    }
+
+    // Turtle path across the level, size is the distance to the goal in steps. The salmon
+    // stands in between and has to be walked around.
+    void bench_pathfinder(Run& run) {
+        const float step = 50.f;
+        NavGrid nav_grid;
+        nav_grid.init(LEVEL_BOUNDS, 16.f);
+
+        vec2 start = {LEVEL_BOUNDS.x - 100.f, LEVEL_BOUNDS.y / 2};
+        vec2 goal = {start.x - step * run.size(), start.y};
+        vec2 middle = mul(add(start, goal), 0.5f);
+        nav_grid.set_obstacle(NavGrid::SALMON, sub(middle, {60.f, 60.f}), add(middle, {60.f, 60.f}));
+
+        auto walkable = [&nav_grid](vec2 position) { return nav_grid.turtle_can_enter(position); };
+        Pathfinder pathfinder;
+        std::list<vec2> path;
+        while (run.keep_running()) {
+            pathfinder.find_path(start, goal, step, walkable, nullptr, path);
+            keep(path.size());
+        }
+        nav_grid.destroy();
+    }
+
+    // Full rebuild of the fish flow field, size is the cell size of the grid
+    void bench_flow_field(Run& run) {
+        NavGrid nav_grid;
+        nav_grid.init(LEVEL_BOUNDS, (float) run.size());
+        FlowField flow_field;
+        flow_field.init(nav_grid, -150.f);
+
+        // Moving the obstacle changes the grid, so every update rebuilds the field
+        float x = 300.f;
+        while (run.keep_running()) {
+            x = x > 900.f ? 300.f : x + 7.f;
+            nav_grid.set_obstacle(NavGrid::SALMON, {x - 60.f, 340.f}, {x + 60.f, 460.f});
+            flow_field.update(nav_grid);
+            keep(flow_field.get_next_waypoint({1000.f, 400.f}));
+        }
+        flow_field.destroy();
+        nav_grid.destroy();
+    }
+
+    // One movement step of a whole school following the flow field, size is the number of fish
+    void bench_fish_update(Run& run) {
+        TextureAtlas atlas;
+        if (!atlas.init({textures_path("fish.png"), textures_path("ramen.png")}))
+            return;
+        NavGrid nav_grid;
+        nav_grid.init(LEVEL_BOUNDS, 16.f);
+        FlowField flow_field;
+        flow_field.init(nav_grid, -150.f);
+        flow_field.update(nav_grid);
+
+        FishSchool fish;
+        if (!fish.init(atlas, false)) {
+            fprintf(stderr, "Failed to load the fish\n");
+            return;
+        }
+        std::default_random_engine rng(7);
+        std::uniform_real_distribution<float> x(0.f, LEVEL_BOUNDS.x);
+        std::uniform_real_distribution<float> y(0.f, LEVEL_BOUNDS.y);
+        for (long i = 0; i < run.size(); ++i)
+            fish.spawn({x(rng), y(rng)});
+
+        // Fish leave through the left edge and are respawned on the right, as World does, so
+        // the size holds
+        run.set_ops_per_iteration((size_t) run.size());
+        while (run.keep_running()) {
+            fish.update(16.f, flow_field);
+            for (size_t i = fish.size(); i-- > 0;) {
+                vec2 position = fish.get_position(i);
+                if (position.x < 0.f) {
+                    fish.remove(i);
+                    fish.spawn({LEVEL_BOUNDS.x, position.y});
+                }
+            }
+            keep(fish.get_position(0));
+        }
+        fish.destroy();
+        flow_field.destroy();
+        nav_grid.destroy();
+        atlas.destroy();
+    }
+
+    // Order in which the entities spawned by a churn iteration are killed
+    std::vector<size_t> kill_order(size_t count) {
+        std::default_random_engine rng(11);
+        std::vector<size_t> order(count);
+        for (size_t i = 0; i < count; ++i)
+            order[i] = i;
+        std::shuffle(order.begin(), order.end(), rng);
+        return order;
+    }
+
+    // Spawns size entities then kills all of them through their handles in random order, one op
+    // is a spawn and a kill. After the first iteration the store is at its peak and nothing may
+    // be allocated anymore.
+    template <typename Store, typename Spawn>
+    void churn(Run& run, Store& store, Spawn spawn) {
+        std::vector<size_t> order = kill_order((size_t) run.size());
+        std::vector<EntityHandle> handles((size_t) run.size());
+        const float* storage = nullptr;
+
+        run.set_ops_per_iteration((size_t) run.size());
+        while (run.keep_running()) {
+            for (size_t i = 0; i < handles.size(); ++i)
+                handles[i] = spawn(i);
+            if (storage == nullptr)
+                storage = store.position_x.data();
+            else if (storage != store.position_x.data())
+                fprintf(stderr, "Store reallocated under churn\n");
+
+            for (size_t i : order) {
+                size_t index;
+                if (store.handles.find(handles[i], index))
+                    store.remove(index);
+            }
+            keep(store.size());
+        }
+    }
+
+    void bench_sprite_store_churn(Run& run) {
+        SpriteStore store;
+        churn(run, store, [&store](size_t i) { return store.add({(float) i, 400.f}, 380.f); });
+    }
+
+    void bench_pebble_store_churn(Run& run) {
+        PebbleStore store;
+        churn(run, store, [&store](size_t i) {
+            return store.add(30000.f, {(float) i, 400.f}, {250.f, 0.f}, {0.f, 0.5f}, 8.f);
+        });
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const char* filter = argc > 1 ? argv[1] : "";
+
+    // Entities create their buffers and shaders through GL
+    null_gl_init();
+
+    std::vector<Benchmark> benchmarks = {
+        {"dot(vec2)", {64, 4096}, bench_dot},
+        {"normalize(vec2)", {64, 4096}, bench_normalize},
+        {"mul(mat3, mat3)", {64, 4096}, bench_mul_mat3},
+        {"mul(mat3, vec3)", {64, 4096}, bench_mul_mat3_vec3},
+        {"Entity::Transform", {64, 1024}, bench_transform},
+        {"transform_points", {64, 4096}, bench_transform_points},
+        {"Salmon::collides_with_wall", {1, 64}, bench_salmon_wall},
+        {"Salmon::calculate_corners", {1, 64}, bench_salmon_corners},
+        {"read_text_mesh", {1}, bench_read_text_mesh},
+        {"MappedMeshFile::open", {1}, bench_map_mesh_file},
+        {"Pebbles::is_inside", {64, 4096}, bench_pebble_is_inside},
+        {"Pebbles::dist", {64, 4096}, bench_pebble_dist},
+        {"Pathfinder::find_path", {4, 8, 16}, bench_pathfinder},
+        {"FlowField::update", {32, 16, 8}, bench_flow_field},
+        {"FishSchool::update", {64, 4096}, bench_fish_update},
+        {"SpriteStore churn", {1000, 100000}, bench_sprite_store_churn},
+        {"PebbleStore churn", {1000, 100000}, bench_pebble_store_churn},
+    };
+
+    std::printf("%-32s %12s %14s\n", "benchmark/size", "ops", "ns/op");
+    for (auto& benchmark : benchmarks) {
+        if (strstr(benchmark.name, filter) != nullptr)
+            run_benchmark(benchmark);
+    }
+
+    return 0;
+}
@@ -0,0 +1,28 @@
+#version 330
+
+// Input attributes
+layout (location = 0) in vec3 in_position;
+layout (location = 1) in vec2 in_texcoord;
+
+// Per sprite attributes, the affine transform as its two axes and translation
+layout (location = 2) in vec2 in_x_axis;
+layout (location = 3) in vec2 in_y_axis;
+layout (location = 4) in vec2 in_translation;
+layout (location = 5) in vec3 in_color;
+layout (location = 6) in vec4 in_uv_rect; // min and max texture coordinates of the sprite
+
+// Passed to fragment shader
+out vec2 texcoord;
+out vec3 color;
+
+// Application data
+uniform mat3 projection;
+
+void main()
+{
+	texcoord = mix(in_uv_rect.xy, in_uv_rect.zw, in_texcoord);
+	color = in_color;
+	vec2 world = in_x_axis * in_position.x + in_y_axis * in_position.y + in_translation;
+	vec3 pos = projection * vec3(world, 1.0);
+	gl_Position = vec4(pos.xy, in_position.z, 1.0);
+}
@@ -0,0 +1,107 @@
+// Header
+#include "asset_loader.hpp"
+
+#include "profiler.hpp"
+
+AssetLoader::AssetLoader() : m_running(false), m_done(nullptr), m_pending(0) {
+}
+
+AssetLoader::~AssetLoader() {
+    destroy();
+}
+
+bool AssetLoader::init(size_t thread_count) {
+    m_running = true;
+    for (size_t i = 0; i < thread_count; ++i)
+        m_threads.emplace_back(&AssetLoader::run, this);
+    return true;
+}
+
+void AssetLoader::destroy() {
+    if (m_threads.empty())
+        return;
+
+    // The results may hold memory only finish() knows how to hand over
+    wait([this] { return m_pending == 0; });
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wakeup.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+    m_threads.clear();
+}
+
+void AssetLoader::submit(std::function<void()> work, std::function<void()> finish) {
+    Job* job = new Job{std::move(work), std::move(finish), nullptr};
+    ++m_pending;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(job);
+    }
+    m_wakeup.notify_one();
+}
+
+size_t AssetLoader::poll() {
+    // Taking the whole list at once, the workers only ever push, so there is no ABA
+    Job* job = m_done.exchange(nullptr, std::memory_order_acquire);
+    size_t finished = 0;
+    while (job != nullptr) {
+        Job* next = job->next;
+        job->finish();
+        delete job;
+        job = next;
+        ++finished;
+    }
+    m_pending -= finished;
+    return finished;
+}
+
+void AssetLoader::wait(const std::function<bool()>& ready) {
+    PROFILE_ZONE("wait for assets");
+    poll();
+    while (!ready() && m_pending > 0) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_job_done.wait(lock, [this] { return m_done.load(std::memory_order_relaxed) != nullptr; });
+        }
+        poll();
+    }
+}
+
+size_t AssetLoader::get_pending() const {
+    return m_pending;
+}
+
+void AssetLoader::run() {
+    Profiler::set_thread_name("asset loader");
+
+    while (true) {
+        Job* job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeup.wait(lock, [this] { return !m_running || !m_queue.empty(); });
+            if (m_queue.empty())
+                return;
+            job = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        {
+            PROFILE_ZONE("load asset");
+            job->work();
+        }
+
+        job->next = m_done.load(std::memory_order_relaxed);
+        while (!m_done.compare_exchange_weak(job->next, job, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+
+        // Taking the lock orders the push before a wait() that is about to sleep
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+        }
+        m_job_done.notify_one();
+    }
+}
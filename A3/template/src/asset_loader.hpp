@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Reads and decodes assets on worker threads
+//
+// A job comes in two halves: work() runs on a worker and does the file reads and the decoding,
+// finish() runs on the game thread, which holds the GL context and owns the objects the result
+// goes into. Workers take jobs from a locked queue, there are only a few of them and they are
+// submitted at startup. Done jobs come back through a lock-free list that poll() empties once per
+// frame, so a worker finishing never blocks the frame and the frame never waits for a worker.
+class AssetLoader
+{
+public:
+    AssetLoader();
+
+    // Stops the workers if destroy() wasn't called, so that a failed startup can still exit
+    ~AssetLoader();
+
+    // Starts thread_count workers
+    bool init(size_t thread_count);
+
+    // Waits for the jobs still queued, finishes them and stops the workers
+    void destroy();
+
+    void submit(std::function<void()> work, std::function<void()> finish);
+
+    // Finishes the jobs done so far, returns how many
+    size_t poll();
+
+    // Finishes jobs, blocking for the next ones, until ready() returns true
+    void wait(const std::function<bool()>& ready);
+
+    // Jobs submitted and not finished yet
+    size_t get_pending() const;
+
+private:
+    struct Job {
+        std::function<void()> work;
+        std::function<void()> finish;
+        Job* next;
+    };
+
+    void run();
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;   // workers, a job was queued or the loader stops
+    std::condition_variable m_job_done; // game thread, a job was done
+    std::deque<Job*> m_queue;
+    bool m_running;
+
+    // Done jobs, pushed by the workers and taken all at once by the game thread
+    std::atomic<Job*> m_done;
+
+    size_t m_pending;
+};
@@ -1,5 +1,11 @@
 #include "common.hpp"
 
+#include "program_cache.hpp"
+
+// Compiled here rather than in main.cpp so that the tools linking common.cpp get it too
+#define GL3W_IMPLEMENTATION
+#include <gl3w.h>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "../ext/stb_image/stb_image.h"
 
@@ -9,6 +15,11 @@
 #include <sstream>
 #include <cmath>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define AFFINE_USE_SSE
+#include <xmmintrin.h>
+#endif
+
 void gl_flush_errors()
 {
 	while (glGetError() != GL_NO_ERROR);
@@ -98,7 +109,58 @@ vec2 normalize(vec2 v)
 	return { v.x / m, v.y / m };
 }
 
-Texture::Texture()
+affine2 affine2::identity()
+{
+	return { { 1.f, 0.f }, { 0.f, 1.f }, { 0.f, 0.f } };
+}
+
+affine2 affine2::from_trs(vec2 position, float radians, vec2 scale)
+{
+	float c = cosf(radians);
+	float s = sinf(radians);
+	return { { c * scale.x, s * scale.x }, { -s * scale.y, c * scale.y }, position };
+}
+
+mat3 affine2::to_mat3() const
+{
+	return { { x_axis.x, x_axis.y, 0.f }, { y_axis.x, y_axis.y, 0.f }, { translation.x, translation.y, 1.f } };
+}
+
+vec2 mul(const affine2& t, vec2 p)
+{
+	return { t.x_axis.x * p.x + t.y_axis.x * p.y + t.translation.x,
+	         t.x_axis.y * p.x + t.y_axis.y * p.y + t.translation.y };
+}
+
+affine2 mul(const affine2& l, const affine2& r)
+{
+	return { { l.x_axis.x * r.x_axis.x + l.y_axis.x * r.x_axis.y, l.x_axis.y * r.x_axis.x + l.y_axis.y * r.x_axis.y },
+	         { l.x_axis.x * r.y_axis.x + l.y_axis.x * r.y_axis.y, l.x_axis.y * r.y_axis.x + l.y_axis.y * r.y_axis.y },
+	         mul(l, r.translation) };
+}
+
+void transform_points(const affine2& t, const vec2* in, vec2* out, size_t count)
+{
+	size_t i = 0;
+#ifdef AFFINE_USE_SSE
+	// Two points per register, as x0 y0 x1 y1
+	const __m128 x_axis = _mm_setr_ps(t.x_axis.x, t.x_axis.y, t.x_axis.x, t.x_axis.y);
+	const __m128 y_axis = _mm_setr_ps(t.y_axis.x, t.y_axis.y, t.y_axis.x, t.y_axis.y);
+	const __m128 translation = _mm_setr_ps(t.translation.x, t.translation.y, t.translation.x, t.translation.y);
+	for (; i + 2 <= count; i += 2)
+	{
+		__m128 points = _mm_loadu_ps(&in[i].x);
+		__m128 xs = _mm_shuffle_ps(points, points, _MM_SHUFFLE(2, 2, 0, 0));
+		__m128 ys = _mm_shuffle_ps(points, points, _MM_SHUFFLE(3, 3, 1, 1));
+		__m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, x_axis), _mm_mul_ps(ys, y_axis)), translation);
+		_mm_storeu_ps(&out[i].x, result);
+	}
+#endif
+	for (; i < count; ++i)
+		out[i] = mul(t, in[i]);
+}
+
+Texture::Texture() : id(0), depth_render_buffer_id(0), width(0), height(0)
 {
 
 }
@@ -129,12 +191,13 @@ bool Texture::load_from_file(const char* path)
 }
 
 // http://www.opengl-tutorial.org/intermediate-tutorials/tutorial-14-render-to-texture/
-bool Texture::create_from_screen(GLFWwindow const * const window) {
+bool Texture::create_from_screen(int screen_width, int screen_height) {
 	gl_flush_errors();
 	glGenTextures(1, &id);
 	glBindTexture(GL_TEXTURE_2D, id);
 
-	glfwGetFramebufferSize(const_cast<GLFWwindow *>(window), &width, &height);
+	width = screen_width;
+	height = screen_height;
 
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -212,6 +275,16 @@ bool Entity::Effect::load_from_file(const char* vs_path, const char* fs_path)
 	GLsizei vs_len = (GLsizei)vs_str.size();
 	GLsizei fs_len = (GLsizei)fs_str.size();
 
+	// Programs linked by an earlier run are loaded as they were, see program_cache.hpp
+	uint64_t cache_key = ProgramCache::key(vs_str, fs_str);
+	program = ProgramCache::load(cache_key);
+	if (program != 0)
+	{
+		vertex = 0;
+		fragment = 0;
+		return true;
+	}
+
 	vertex = glCreateShader(GL_VERTEX_SHADER);
 	glShaderSource(vertex, 1, &vs_src, &vs_len);
 	fragment = glCreateShader(GL_FRAGMENT_SHADER);
@@ -232,6 +305,7 @@ bool Entity::Effect::load_from_file(const char* vs_path, const char* fs_path)
 	program = glCreateProgram();
 	glAttachShader(program, vertex);
 	glAttachShader(program, fragment);
+	ProgramCache::prepare(cache_key, program);
 	glLinkProgram(program);
 	{
 		GLint is_linked = 0;
@@ -256,6 +330,7 @@ bool Entity::Effect::load_from_file(const char* vs_path, const char* fs_path)
 		return false;
 	}
 
+	ProgramCache::save(cache_key, program);
 	return true;
 }
 
@@ -266,32 +341,28 @@ void Entity::Effect::release()
 	glDeleteShader(fragment);
 }
 
-void Entity::Transform::begin()
+void Entity::save_motion()
 {
-	out = { { 1.f, 0.f, 0.f }, { 0.f, 1.f, 0.f}, { 0.f, 0.f, 1.f} };
+	last_motion = motion;
 }
 
-void Entity::Transform::scale(vec2 scale)
+void Entity::set_draw_alpha(float alpha)
 {
-	mat3 S = { { scale.x, 0.f, 0.f },{ 0.f, scale.y, 0.f },{ 0.f, 0.f, 1.f } };
-	out = mul(out, S);
+	draw_alpha = alpha;
 }
 
-void Entity::Transform::rotate(float radians)
+vec2 Entity::get_draw_position() const
 {
-	float c = cosf(radians);
-	float s = sinf(radians);
-	mat3 R = { { c, s, 0.f },{ -s, c, 0.f },{ 0.f, 0.f, 1.f } };
-	out = mul(out, R);
+	return add(mul(last_motion.position, 1.f - draw_alpha), mul(motion.position, draw_alpha));
 }
 
-void Entity::Transform::translate(vec2 offset)
+float Entity::get_draw_radians() const
 {
-	mat3 T = { { 1.f, 0.f, 0.f },{ 0.f, 1.f, 0.f },{ offset.x, offset.y, 1.f } };
-	out = mul(out, T);
+	return last_motion.radians * (1.f - draw_alpha) + motion.radians * draw_alpha;
 }
 
-void Entity::Transform::end()
+void Entity::Transform::set(vec2 position, float radians, vec2 scale)
 {
-	//
+	affine = affine2::from_trs(position, radians, scale);
+	out = affine.to_mat3();
 }
\ No newline at end of file
@@ -37,6 +37,20 @@ struct vec3 {
 };
 struct mat3 { vec3 c0, c1, c2; };
 
+// 2D affine transform, a mat3 whose last row is (0, 0, 1) kept as its first two rows.
+// A point p goes to x_axis * p.x + y_axis * p.y + translation.
+struct affine2 {
+	vec2 x_axis, y_axis, translation;
+
+	static affine2 identity();
+
+	// Translation, then rotation, then scale: 4 multiplies past the sine and cosine, where
+	// composing the three as mat3s takes 81
+	static affine2 from_trs(vec2 position, float radians, vec2 scale);
+
+	mat3 to_mat3() const;
+};
+
 // Utility functions
 float dot(vec2 l, vec2 r);
 float dot(vec3 l, vec3 r);
@@ -49,6 +63,12 @@ vec2 sub(vec2 a, vec2 b);
 vec2 to_vec2(vec3 v);
 float sq_len(vec2 a);
 float len(vec2 a);
+vec2 mul(const affine2& t, vec2 p);
+affine2 mul(const affine2& l, const affine2& r);
+
+// Transforms count points, in and out can be the same array. Runs on two points at a time
+// with SSE.
+void transform_points(const affine2& t, const vec2* in, vec2* out, size_t count);
 
 
 
@@ -85,7 +105,7 @@ struct Texture
 	// Loads texture from file specified by path
 	bool load_from_file(const char* path);
 	bool is_valid()const; // True if texture is valid
-	bool create_from_screen(GLFWwindow const * const window); // Screen texture
+	bool create_from_screen(int width, int height); // Screen texture, framebuffer sized
 };
 
 // An entity boils down to a collection of components,
@@ -95,7 +115,14 @@ struct Entity {
 	// renders itself it needs it to correctly bind it to its shader.
 	virtual void draw(const mat3& projection) = 0;
 
-protected:
+	// Saves the current motion, the following draws interpolate from it. Called before every update.
+	void save_motion();
+
+	// Fraction of the next update already elapsed when drawing, in [0, 1]. The simulation runs
+	// ahead of the screen by up to one update, so entities are drawn between their saved and
+	// their current motion.
+	void set_draw_alpha(float alpha);
+
 	// A Mesh is a collection of a VertexBuffer and an IndexBuffer. A VAO
 	// represents a Vertex Array Object and is the container for 1 or more Vertex Buffers and 
 	// an Index Buffer.
@@ -103,7 +130,7 @@ protected:
 		GLuint vao;
 		GLuint vbo;
 		GLuint ibo;
-	} mesh;
+	};
 
 	// Effect component of Entity for Vertex and Fragment shader, which are then put(linked) together in a
 	// single program that is then bound to the pipeline.
@@ -114,7 +141,11 @@ protected:
 
 		bool load_from_file(const char* vs_path, const char* fs_path); // load shaders from files and link into program
 		void release(); // release shaders and program
-	} effect;
+	};
+
+protected:
+	Mesh mesh;
+	Effect effect;
 
 	// All data relevant to the motion of the salmon.
 	struct Motion {
@@ -123,22 +154,26 @@ protected:
 		float speed;
 	} motion;
 
+	// Motion at the start of the last update and where to draw between it and the current one
+	Motion last_motion;
+	float draw_alpha = 1.f;
+
+	vec2 get_draw_position() const;
+	float get_draw_radians() const;
+
 	// Scale is used in the bounding box calculations, 
 	// and so contextually belongs here (for now).
 	struct Physics {
 		vec2 scale;
 	} physics;
 
-	// Transform component handles transformations passed to the Vertex shader.
-	// gl Immediate mode equivalent, see the Rendering and Transformations section in the
-	// specification pdf.
+	// Transform component handles transformations passed to the Vertex shader, see the
+	// Rendering and Transformations section in the specification pdf.
 	struct Transform {
-		mat3 out;
+		affine2 affine;
+		mat3 out; // affine as a mat3, for the shaders
 
-		void begin();
-		void scale(vec2 scale);
-		void rotate(float radians);
-		void translate(vec2 offset);
-		void end();
+		// Translation, then rotation, then scale
+		void set(vec2 position, float radians, vec2 scale);
 	} transform;
 };
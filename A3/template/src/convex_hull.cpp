@@ -0,0 +1,83 @@
+// Header
+#include "convex_hull.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Positive if a, b, c turn counter-clockwise (with y up), 0 if they are collinear
+    float cross(vec2 a, vec2 b, vec2 c) {
+        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    }
+}
+
+std::vector<vec2> convex_hull(std::vector<vec2> points) {
+    std::sort(points.begin(), points.end(), [](vec2 a, vec2 b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    });
+    points.erase(std::unique(points.begin(), points.end(), [](vec2 a, vec2 b) {
+        return a.x == b.x && a.y == b.y;
+    }), points.end());
+
+    if (points.size() < 3)
+        return points;
+
+    // Lower half from left to right then upper half from right to left, a point is popped as
+    // soon as it would make the chain turn the wrong way
+    std::vector<vec2> hull(2 * points.size());
+    size_t count = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        while (count >= 2 && cross(hull[count - 2], hull[count - 1], points[i]) <= 0.f)
+            --count;
+        hull[count++] = points[i];
+    }
+    for (size_t i = points.size() - 1, lower = count + 1; i-- > 0;) {
+        while (count >= lower && cross(hull[count - 2], hull[count - 1], points[i]) <= 0.f)
+            --count;
+        hull[count++] = points[i];
+    }
+
+    // The last point is the first one again
+    hull.resize(count - 1);
+    return hull;
+}
+
+bool hull_overlaps_box(const vec2* hull, size_t count, vec2 box_min, vec2 box_max) {
+    if (count == 0)
+        return false;
+
+    // Box axes, the hull bounds against the box
+    vec2 hull_min = hull[0];
+    vec2 hull_max = hull[0];
+    for (size_t i = 1; i < count; ++i) {
+        hull_min = { std::min(hull_min.x, hull[i].x), std::min(hull_min.y, hull[i].y) };
+        hull_max = { std::max(hull_max.x, hull[i].x), std::max(hull_max.y, hull[i].y) };
+    }
+    if (hull_max.x < box_min.x || hull_min.x > box_max.x ||
+        hull_max.y < box_min.y || hull_min.y > box_max.y)
+        return false;
+
+    // Hull edge normals, the box projects to its center plus or minus its half extents
+    vec2 center = mul(add(box_min, box_max), 0.5f);
+    vec2 half = mul(sub(box_max, box_min), 0.5f);
+    for (size_t i = 0; i < count; ++i) {
+        vec2 edge = sub(hull[(i + 1) % count], hull[i]);
+        vec2 normal = { -edge.y, edge.x };
+
+        float min = dot(hull[0], normal);
+        float max = min;
+        for (size_t j = 1; j < count; ++j) {
+            float projection = dot(hull[j], normal);
+            min = std::min(min, projection);
+            max = std::max(max, projection);
+        }
+
+        float box_center = dot(center, normal);
+        float box_radius = half.x * std::fabs(normal.x) + half.y * std::fabs(normal.y);
+        if (max < box_center - box_radius || min > box_center + box_radius)
+            return false;
+    }
+
+    return true;
+}
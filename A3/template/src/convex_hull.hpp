@@ -0,0 +1,21 @@
+#pragma once
+
+#include "common.hpp"
+
+#include <vector>
+
+// Convex hulls and separating axis tests, for colliding the salmon mesh without going through
+// all of its vertices.
+//
+// A hull is a convex polygon given by its corners in order around it. The tests only look at
+// the edges and the projections on their normals, so a hull mirrored by a negative scale, which
+// flips the order of its corners, works the same.
+
+// Corners of the smallest convex polygon containing points, counter-clockwise (Andrew's
+// monotone chain). Points in the middle of an edge are dropped.
+std::vector<vec2> convex_hull(std::vector<vec2> points);
+
+// True if the hull and the axis aligned box from box_min to box_max overlap. The axes tested
+// are the two of the box and the normals of the hull edges, there is no overlap as soon as the
+// projections of the two shapes on one of them are apart.
+bool hull_overlaps_box(const vec2* hull, size_t count, vec2 box_min, vec2 box_max);
@@ -75,9 +75,7 @@ bool DebugBoundaries::init(vec2 x_level_bounds, vec2 y_level_bounds, vec2 window
 void DebugBoundaries::destroy() {
     glDeleteBuffers(1, &mesh.vbo);
 
-    glDeleteShader(effect.vertex);
-    glDeleteShader(effect.fragment);
-    glDeleteShader(effect.program);
+    effect.release();
 }
 
 
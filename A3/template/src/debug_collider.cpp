@@ -24,9 +24,7 @@ bool DebugCollider::init(vec2 x_bounds, vec2 y_bounds, vec2 window_size, vec2 sa
 void DebugCollider::destroy() {
     glDeleteBuffers(1, &mesh.vbo);
 
-    glDeleteShader(effect.vertex);
-    glDeleteShader(effect.fragment);
-    glDeleteShader(effect.program);
+    effect.release();
 }
 
 
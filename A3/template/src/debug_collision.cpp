@@ -20,9 +20,7 @@ bool DebugCollision::init(Salmon& salmon) {
 void DebugCollision::destroy() {
     glDeleteBuffers(1, &mesh.vbo);
 
-    glDeleteShader(effect.vertex);
-    glDeleteShader(effect.fragment);
-    glDeleteShader(effect.program);
+    effect.release();
 
     m_points.clear();
 }
@@ -76,13 +74,8 @@ void DebugCollision::draw(const mat3& projection) {
     glUniform3fv(color_uloc, 1, color);
     glUniformMatrix3fv(projection_uloc, 1, GL_FALSE, (float*)&projection);
 
-    mat3 trans = m_salmon->get_transformation_matrix();
-    transform.begin();
-    transform.translate(m_salmon->get_position());
-    transform.rotate(m_salmon->get_rotation());
-    transform.scale(m_salmon->get_scale());
-    transform.end();
-    glUniformMatrix3fv(transform_uloc, 1, GL_FALSE, (float*)&trans);
+    transform.set(m_salmon->get_position(), m_salmon->get_rotation(), m_salmon->get_scale());
+    glUniformMatrix3fv(transform_uloc, 1, GL_FALSE, (float*)&transform.out);
 
     // Enabling alpha channel for textures
     glEnable(GL_BLEND);
@@ -22,9 +22,7 @@ bool DebugPath::init(vec2 screen_size) {
 void DebugPath::destroy() {
 	glDeleteBuffers(1, &mesh.vbo);
 
-	glDeleteShader(effect.vertex);
-	glDeleteShader(effect.fragment);
-	glDeleteShader(effect.program);
+	effect.release();
 
 	clear_paths();
 }
@@ -2,60 +2,67 @@
 
 #include <list>
 #include "common.hpp"
-#include "salmon.hpp"
-#include "sector.hpp"
+#include "flow_field.hpp"
+#include "sprite_store.hpp"
+#include "sprite_batch.hpp"
+#include "texture_atlas.hpp"
 
-// Salmon food
-class Fish : public Entity
-{
-	// Shared between all fish, no need to load one for each instance
-	static Texture fish_texture;
+#include <vector>
 
+// Salmon food, all the fish of the level stored by component, see sprite_store.hpp
+class FishSchool
+{
 public:
-	// Creates all the associated render resources and default transform
-	bool init(bool m_mode3);
+	// Finds both skins in the atlas, starts with the reskinned one in mode 3
+	bool init(const TextureAtlas& atlas, bool mode3);
 
-	// Releases all the associated resources
+	// Removes the fish
 	void destroy();
-	
-	// Update fish
-	// ms represents the number of milliseconds elapsed from the previous update() call
-	void update(float ms);
 
-	// Renders the fish
-	// projection is the 2D orthographic projection matrix
-	void draw(const mat3& projection) override;
+	// Adds a fish at position
+	EntityHandle spawn(vec2 position);
 
-	// Returns the current fish position
-	vec2 get_position() const;
+	// Moves the last fish into index
+	void remove(size_t index);
 
-	// Sets the new fish position
-	void set_position(vec2 position);
+	// Removes every fish
+	void clear();
 
-	// Returns the fish' bounding box for collision detection, called by collides_with()
-	vec2 get_bounding_box() const;
+	size_t size() const;
+
+	// Where this update starts from, called before every update
+	void save_positions();
+
+	// Moves every fish along the shared flow field
+	// ms represents the number of milliseconds elapsed from the previous update() call
+	void update(float ms, const FlowField& flow_field);
+
+	// Queues every fish in the sprite batch, alpha of the way from the last update
+	void draw(SpriteBatch& batch, float alpha) const;
 
-	void calculate_path(Salmon& m_salmon);
+	vec2 get_position(size_t index) const;
 
-    std::list<vec2> get_path();
+	// Bounding box of every fish for collision detection
+	vec2 get_bounding_box() const;
 
-    bool load_texture();
-    bool default_texture();
-    bool reskin();
+    // Switches the skin of every fish, the atlas already holds both
+    void default_texture();
+    void reskin();
 
-    void slow_down();
+    // Slows a fish down for a moment, when a pebble hits it
+    void slow_down(size_t index);
 
 private:
-    bool value_in_list (std::list<Sector> open_list, std::list<Sector> closed_list, Sector value);
+    const Texture* m_texture;
+    SpriteSkin m_skin;
+    SpriteSkin m_default_skin;
+    SpriteSkin m_reskin;
+    SpriteStore m_store;
+
+    // Time since each fish was slowed down, negative while it swims at full speed
+    std::vector<float> m_slowed_ms;
 
     float m_base_speed;
     float m_slow_speed;
-    float m_speed_timer;
     float m_speed_reset;
-    bool m_slowed;
-
-    vec2 m_reskin_scale;
-    vec2 m_default_scale;
-
-    std::list<vec2> m_path;
-};
\ No newline at end of file
+};
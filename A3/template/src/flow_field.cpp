@@ -0,0 +1,167 @@
+// Header
+#include "flow_field.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace
+{
+    const float UNREACHABLE = std::numeric_limits<float>::max();
+
+    // Minimum spacing between two points of a traced path
+    const float TRACE_SPACING = 50.f;
+
+    const int NEIGHBOURS_X[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
+    const int NEIGHBOURS_Y[8] = {-1, -1, -1, 0, 0, 1, 1, 1};
+}
+
+bool FlowField::init(const NavGrid& nav_grid, float exit_x) {
+    m_width = nav_grid.get_width();
+    m_height = nav_grid.get_height();
+    m_cell_size = nav_grid.get_cell_size();
+    m_exit_x = exit_x;
+    m_built = false;
+
+    size_t cells = (size_t) m_width * m_height;
+    m_centers.resize(cells);
+    m_walkable.assign(cells, false);
+    m_distances.assign(cells, UNREACHABLE);
+    m_queue.clear();
+    m_queue.reserve(cells);
+
+    for (int y = 0; y < m_height; ++y)
+        for (int x = 0; x < m_width; ++x)
+            m_centers[y * m_width + x] = nav_grid.get_cell_center(x, y);
+
+    m_origin = sub(m_centers[0], {m_cell_size * 0.5f, m_cell_size * 0.5f});
+    return true;
+}
+
+void FlowField::destroy() {
+    m_centers.clear();
+    m_walkable.clear();
+    m_distances.clear();
+    m_queue.clear();
+    m_built = false;
+}
+
+void FlowField::update(const NavGrid& nav_grid) {
+    if (m_built && nav_grid.get_version() == m_version)
+        return;
+
+    m_version = nav_grid.get_version();
+    m_built = true;
+
+    std::greater<std::pair<float, int>> cmp;
+    m_queue.clear();
+
+    for (size_t cell = 0; cell < m_centers.size(); ++cell) {
+        m_walkable[cell] = nav_grid.fish_can_enter(m_centers[cell]);
+        m_distances[cell] = UNREACHABLE;
+
+        if (m_walkable[cell] && m_centers[cell].x <= m_exit_x) {
+            m_distances[cell] = 0.f;
+            m_queue.push_back({0.f, (int) cell});
+        }
+    }
+    std::make_heap(m_queue.begin(), m_queue.end(), cmp);
+
+    float diagonal = m_cell_size * std::sqrt(2.f);
+    while (!m_queue.empty()) {
+        std::pop_heap(m_queue.begin(), m_queue.end(), cmp);
+        float distance = m_queue.back().first;
+        int cell = m_queue.back().second;
+        m_queue.pop_back();
+
+        if (distance > m_distances[cell])
+            continue;
+
+        int x = cell % m_width;
+        int y = cell / m_width;
+        for (int i = 0; i < 8; ++i) {
+            int nx = x + NEIGHBOURS_X[i];
+            int ny = y + NEIGHBOURS_Y[i];
+            bool is_diagonal = NEIGHBOURS_X[i] != 0 && NEIGHBOURS_Y[i] != 0;
+
+            // No cutting corners around obstacles
+            if (!is_walkable(nx, ny) ||
+                (is_diagonal && (!is_walkable(nx, y) || !is_walkable(x, ny))))
+                continue;
+
+            int neighbour = ny * m_width + nx;
+            float neighbour_distance = distance + (is_diagonal ? diagonal : m_cell_size);
+            if (neighbour_distance < m_distances[neighbour]) {
+                m_distances[neighbour] = neighbour_distance;
+                m_queue.push_back({neighbour_distance, neighbour});
+                std::push_heap(m_queue.begin(), m_queue.end(), cmp);
+            }
+        }
+    }
+}
+
+vec2 FlowField::get_next_waypoint(vec2 position) const {
+    int x = (int) std::floor((position.x - m_origin.x) / m_cell_size);
+    int y = (int) std::floor((position.y - m_origin.y) / m_cell_size);
+
+    int next = -1;
+    if (m_built && x >= 0 && y >= 0 && x < m_width && y < m_height)
+        next = get_next_cell(y * m_width + x);
+
+    // Past the exit or cut off from it, keep swimming left
+    if (next < 0)
+        return {position.x - m_cell_size, position.y};
+
+    return m_centers[next];
+}
+
+void FlowField::trace(vec2 position, std::list<vec2>& path) const {
+    path.clear();
+    path.push_back(position);
+
+    int x = (int) std::floor((position.x - m_origin.x) / m_cell_size);
+    int y = (int) std::floor((position.y - m_origin.y) / m_cell_size);
+    if (!m_built || x < 0 || y < 0 || x >= m_width || y >= m_height)
+        return;
+
+    // Distances strictly decrease along the way, so the trace always ends
+    int cell = y * m_width + x;
+    for (int next = get_next_cell(cell); next >= 0; next = get_next_cell(cell)) {
+        cell = next;
+        if (len(sub(m_centers[cell], path.back())) >= TRACE_SPACING)
+            path.push_back(m_centers[cell]);
+    }
+
+    if (len(sub(m_centers[cell], path.back())) > 0.f)
+        path.push_back(m_centers[cell]);
+}
+
+int FlowField::get_next_cell(int cell) const {
+    int x = cell % m_width;
+    int y = cell / m_width;
+
+    int best = -1;
+    float best_distance = m_distances[cell];
+    for (int i = 0; i < 8; ++i) {
+        int nx = x + NEIGHBOURS_X[i];
+        int ny = y + NEIGHBOURS_Y[i];
+        bool is_diagonal = NEIGHBOURS_X[i] != 0 && NEIGHBOURS_Y[i] != 0;
+
+        if (!is_walkable(nx, ny) ||
+            (is_diagonal && (!is_walkable(nx, y) || !is_walkable(x, ny))))
+            continue;
+
+        int neighbour = ny * m_width + nx;
+        if (m_distances[neighbour] < best_distance) {
+            best = neighbour;
+            best_distance = m_distances[neighbour];
+        }
+    }
+
+    return best;
+}
+
+bool FlowField::is_walkable(int x, int y) const {
+    return x >= 0 && y >= 0 && x < m_width && y < m_height && m_walkable[y * m_width + x];
+}
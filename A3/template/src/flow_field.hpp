@@ -0,0 +1,51 @@
+#pragma once
+
+#include "common.hpp"
+#include "nav_grid.hpp"
+
+#include <list>
+#include <vector>
+
+// Distance field towards the exit column, shared by all the fish
+//
+// All the fish head for the same column on the left of the screen, so instead of one search
+// per fish a single Dijkstra is run from every exit cell over the NavGrid. Each fish then
+// only has to step towards the neighbouring cell that is closest to the exit.
+// The field is only rebuilt when the obstacles of the grid changed.
+class FlowField
+{
+public:
+    // Cells whose center is left of exit_x are exits
+    bool init(const NavGrid& nav_grid, float exit_x);
+
+    // Releases the field
+    void destroy();
+
+    // Rebuilds the field if the grid changed since the last update
+    void update(const NavGrid& nav_grid);
+
+    // Position a fish at the given position should head to next
+    vec2 get_next_waypoint(vec2 position) const;
+
+    // Follows the field from position to the exit, for debugging
+    void trace(vec2 position, std::list<vec2>& path) const;
+
+private:
+    // Neighbour of cell with the lowest distance, -1 if none is closer to the exit
+    int get_next_cell(int cell) const;
+
+    bool is_walkable(int x, int y) const;
+
+    vec2 m_origin;
+    int m_width;
+    int m_height;
+    float m_cell_size;
+    float m_exit_x;
+    unsigned int m_version;
+    bool m_built;
+
+    std::vector<vec2> m_centers;
+    std::vector<bool> m_walkable;
+    std::vector<float> m_distances;
+    std::vector<std::pair<float, int>> m_queue; // binary heap, lowest distance on top
+};
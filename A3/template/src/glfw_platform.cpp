@@ -0,0 +1,228 @@
+// Header
+#include "glfw_platform.hpp"
+
+#include <memory>
+
+namespace
+{
+    void glfw_err_cb(int error, const char* desc)
+    {
+        fprintf(stderr, "%d: %s", error, desc);
+    }
+
+    // The music has channel 0 to itself, the sound effects share the voices after it
+    const int MUSIC_CHANNEL = 0;
+    const int VOICE_COUNT = 8;
+    const int VOICE_GROUP = 1;
+
+    // Sounds of every theme, in the order of Audio::Theme
+    const int SOUNDS_PER_THEME = 3;
+    struct ThemePaths {
+        const char* music;
+        const char* salmon_dead;
+        const char* salmon_eat;
+    };
+
+    const ThemePaths THEME_PATHS[Audio::THEME_COUNT] = {
+        { audio_path("music.wav"), audio_path("salmon_dead.wav"), audio_path("salmon_eat.wav") },
+        { audio_path("music2.wav"), audio_path("dead.wav"), audio_path("eat.wav") },
+    };
+}
+
+bool GlfwWindow::init(vec2 screen) {
+    //-------------------------------------------------------------------------
+    // GLFW / OGL Initialization
+    // Core Opengl 3.
+    glfwSetErrorCallback(glfw_err_cb);
+    if (!glfwInit())
+    {
+        fprintf(stderr, "Failed to initialize GLFW");
+        return false;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, 1);
+#if __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    glfwWindowHint(GLFW_RESIZABLE, 0);
+    m_window = glfwCreateWindow((int)screen.x, (int)screen.y, "Salmon Game Assignment", nullptr, nullptr);
+    if (m_window == nullptr)
+        return false;
+
+    glfwMakeContextCurrent(m_window);
+    glfwSwapInterval(1); // vsync
+
+    // Load OpenGL function pointers
+    gl3w_init();
+
+    // Setting callbacks to member functions (that's why the redirect is needed)
+    // Input is handled using GLFW, for more info see
+    // http://www.glfw.org/docs/latest/input_guide.html
+    glfwSetWindowUserPointer(m_window, this);
+    auto key_redirect = [](GLFWwindow* wnd, int _0, int _1, int _2, int _3) {
+        GlfwWindow* window = (GlfwWindow*)glfwGetWindowUserPointer(wnd);
+        if (window->m_on_key)
+            window->m_on_key(_0, _2, _3);
+    };
+    auto cursor_pos_redirect = [](GLFWwindow* wnd, double _0, double _1) {
+        GlfwWindow* window = (GlfwWindow*)glfwGetWindowUserPointer(wnd);
+        if (window->m_on_mouse_move)
+            window->m_on_mouse_move(_0, _1);
+    };
+    auto mouse_button_redirect = [](GLFWwindow* wnd, int _0, int _1, int _2) {
+        GlfwWindow* window = (GlfwWindow*)glfwGetWindowUserPointer(wnd);
+        if (window->m_on_mouse_click)
+            window->m_on_mouse_click(_0, _1, _2);
+    };
+    glfwSetKeyCallback(m_window, key_redirect);
+    glfwSetCursorPosCallback(m_window, cursor_pos_redirect);
+    glfwSetMouseButtonCallback(m_window, mouse_button_redirect);
+
+    return true;
+}
+
+void GlfwWindow::destroy() {
+    if (m_window != nullptr)
+        glfwDestroyWindow(m_window);
+    m_window = nullptr;
+}
+
+void GlfwWindow::set_callbacks(KeyCallback on_key, CursorCallback on_mouse_move,
+                               MouseButtonCallback on_mouse_click) {
+    m_on_key = on_key;
+    m_on_mouse_move = on_mouse_move;
+    m_on_mouse_click = on_mouse_click;
+}
+
+void GlfwWindow::poll_events() {
+    // Processes system messages, if this wasn't present the window would become unresponsive
+    glfwPollEvents();
+}
+
+void GlfwWindow::get_framebuffer_size(int& width, int& height) const {
+    glfwGetFramebufferSize(m_window, &width, &height);
+}
+
+vec2 GlfwWindow::get_cursor_position() const {
+    double x, y;
+    glfwGetCursorPos(m_window, &x, &y);
+    return {(float) x, (float) y};
+}
+
+void GlfwWindow::set_title(const char* title) {
+    glfwSetWindowTitle(m_window, title);
+}
+
+void GlfwWindow::swap_buffers() {
+    glfwSwapBuffers(m_window);
+}
+
+bool GlfwWindow::should_close() const {
+    return glfwWindowShouldClose(m_window);
+}
+
+bool SdlAudio::init() {
+    //-------------------------------------------------------------------------
+    // Loading music and sounds
+    if (SDL_Init(SDL_INIT_AUDIO) < 0)
+    {
+        fprintf(stderr, "Failed to initialize SDL Audio");
+        return false;
+    }
+
+    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) == -1)
+    {
+        fprintf(stderr, "Failed to open audio device");
+        return false;
+    }
+
+    // Playing on any channel never picks the music one
+    Mix_AllocateChannels(1 + VOICE_COUNT);
+    Mix_ReserveChannels(1);
+    Mix_GroupChannels(MUSIC_CHANNEL + 1, MUSIC_CHANNEL + VOICE_COUNT, VOICE_GROUP);
+
+    return true;
+}
+
+void SdlAudio::destroy() {
+    Mix_HaltChannel(-1);
+
+    for (auto& sounds : m_themes) {
+        for (Mix_Chunk** chunk : {&sounds.music, &sounds.salmon_dead, &sounds.salmon_eat}) {
+            if (*chunk != nullptr)
+                Mix_FreeChunk(*chunk);
+            *chunk = nullptr;
+        }
+    }
+    m_sounds = nullptr;
+    m_resident_bytes = 0;
+    m_finished_sounds = 0;
+
+    Mix_CloseAudio();
+}
+
+void SdlAudio::load(AssetLoader& loader) {
+    for (int theme = 0; theme < THEME_COUNT; ++theme) {
+        const ThemePaths& paths = THEME_PATHS[theme];
+        Sounds& sounds = m_themes[theme];
+        load_sound(loader, paths.music, sounds.music);
+        load_sound(loader, paths.salmon_dead, sounds.salmon_dead);
+        load_sound(loader, paths.salmon_eat, sounds.salmon_eat);
+    }
+}
+
+void SdlAudio::set_theme(Theme theme) {
+    m_sounds = &m_themes[theme];
+
+    // Music still decoding starts once it is finished
+    if (m_sounds->music != nullptr)
+        Mix_PlayChannel(MUSIC_CHANNEL, m_sounds->music, -1);
+    else
+        Mix_HaltChannel(MUSIC_CHANNEL);
+}
+
+void SdlAudio::play_salmon_dead() {
+    play(m_sounds->salmon_dead);
+}
+
+void SdlAudio::play_salmon_eat() {
+    play(m_sounds->salmon_eat);
+}
+
+size_t SdlAudio::get_resident_bytes() const {
+    return m_resident_bytes;
+}
+
+void SdlAudio::load_sound(AssetLoader& loader, const char* path, Mix_Chunk*& chunk) {
+    // Decoding only reads the format of the opened device, the mixer itself is left to the game
+    // thread. The worker hands the chunk over through decoded.
+    auto decoded = std::make_shared<Mix_Chunk*>(nullptr);
+    loader.submit([path, decoded] { *decoded = Mix_LoadWAV(path); },
+                  [this, path, decoded, &chunk] {
+        chunk = *decoded;
+        if (chunk == nullptr)
+            fprintf(stderr, "Failed to load sound %s, make sure the data directory is present\n", path);
+        else
+            m_resident_bytes += chunk->alen;
+
+        if (chunk != nullptr && m_sounds != nullptr && &chunk == &m_sounds->music)
+            Mix_PlayChannel(MUSIC_CHANNEL, chunk, -1);
+
+        if (++m_finished_sounds == THEME_COUNT * SOUNDS_PER_THEME)
+            fprintf(stderr, "Loaded %d sounds, %.1f MB of audio resident\n", m_finished_sounds,
+                    m_resident_bytes / (1024.0 * 1024.0));
+    });
+}
+
+void SdlAudio::play(Mix_Chunk* chunk) {
+    if (chunk == nullptr)
+        return;
+
+    int channel = Mix_GroupAvailable(VOICE_GROUP);
+    if (channel == -1)
+        channel = Mix_GroupOldest(VOICE_GROUP);
+    Mix_PlayChannel(channel, chunk, 0);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "platform.hpp"
+
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+#include <SDL_mixer.h>
+
+// Window and Core OpenGL 3.3 context created through GLFW
+class GlfwWindow : public Window
+{
+public:
+    bool init(vec2 screen) override;
+    void destroy() override;
+    void set_callbacks(KeyCallback on_key, CursorCallback on_mouse_move,
+                       MouseButtonCallback on_mouse_click) override;
+    void poll_events() override;
+    void get_framebuffer_size(int& width, int& height) const override;
+    vec2 get_cursor_position() const override;
+    void set_title(const char* title) override;
+    void swap_buffers() override;
+    bool should_close() const override;
+
+private:
+    GLFWwindow* m_window = nullptr;
+
+    KeyCallback m_on_key;
+    CursorCallback m_on_mouse_move;
+    MouseButtonCallback m_on_mouse_click;
+};
+
+// Music and sound effects through SDL_mixer
+//
+// Every theme is decoded into chunks on the asset loader and stays resident, switching theme only
+// changes which chunks are played. The music loops on a channel of its own. The sound
+// effects share a fixed pool of voices: a burst of them never takes more channels, when all the
+// voices are busy the one playing for the longest is cut.
+class SdlAudio : public Audio
+{
+public:
+    bool init() override;
+    void destroy() override;
+    void load(AssetLoader& loader) override;
+    void set_theme(Theme theme) override;
+    void play_salmon_dead() override;
+    void play_salmon_eat() override;
+    size_t get_resident_bytes() const override;
+
+private:
+    struct Sounds {
+        Mix_Chunk* music = nullptr;
+        Mix_Chunk* salmon_dead = nullptr;
+        Mix_Chunk* salmon_eat = nullptr;
+    };
+
+    // Decodes the sound at path on a worker, chunk is set once it is finished
+    void load_sound(AssetLoader& loader, const char* path, Mix_Chunk*& chunk);
+
+    // Plays a sound effect on a free voice, or on the one that has been playing the longest
+    void play(Mix_Chunk* chunk);
+
+    Sounds m_themes[THEME_COUNT];
+    const Sounds* m_sounds = nullptr;
+    size_t m_resident_bytes = 0;
+    int m_finished_sounds = 0;
+};
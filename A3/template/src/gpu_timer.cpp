@@ -0,0 +1,83 @@
+// Header
+#include "gpu_timer.hpp"
+
+namespace
+{
+    // Frames between issuing a query and reading it back
+    const size_t FRAMES_IN_FLIGHT = 4;
+
+    // Weight of the newest frame in the average
+    const float SMOOTHING = 0.05f;
+}
+
+GpuTimer::GpuTimer() : m_frame(0) {
+}
+
+bool GpuTimer::init(size_t pass_count) {
+    m_frames.assign(FRAMES_IN_FLIGHT, std::vector<Query>());
+    m_frame = 0;
+    m_frame_ns.assign(pass_count, 0);
+    m_ms.assign(pass_count, 0.f);
+    return true;
+}
+
+void GpuTimer::destroy() {
+    for (auto& frame : m_frames) {
+        for (auto& query : frame)
+            m_free.push_back(query.id);
+        frame.clear();
+    }
+
+    if (!m_free.empty())
+        glDeleteQueries((GLsizei) m_free.size(), m_free.data());
+    m_free.clear();
+}
+
+void GpuTimer::begin_frame() {
+    m_frame = (m_frame + 1) % FRAMES_IN_FLIGHT;
+    std::vector<Query>& queries = m_frames[m_frame];
+    if (queries.empty())
+        return;
+
+    // Queries finish in order, the others are done if the last one is. If even that one is late
+    // the frame is skipped rather than waited for.
+    GLint available = 0;
+    glGetQueryObjectiv(queries.back().id, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available) {
+        std::fill(m_frame_ns.begin(), m_frame_ns.end(), 0);
+        for (auto& query : queries) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &ns);
+            m_frame_ns[query.pass] += ns;
+        }
+
+        // Passes that did not run in that frame count as 0 ms
+        for (size_t pass = 0; pass < m_ms.size(); ++pass)
+            m_ms[pass] += SMOOTHING * (m_frame_ns[pass] / 1000000.f - m_ms[pass]);
+    }
+
+    for (auto& query : queries)
+        m_free.push_back(query.id);
+    queries.clear();
+}
+
+void GpuTimer::begin(size_t pass) {
+    GLuint id;
+    if (m_free.empty()) {
+        glGenQueries(1, &id);
+    } else {
+        id = m_free.back();
+        m_free.pop_back();
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, id);
+    m_frames[m_frame].push_back({pass, id});
+}
+
+void GpuTimer::end() {
+    glEndQuery(GL_TIME_ELAPSED);
+}
+
+float GpuTimer::get_ms(size_t pass) const {
+    return m_ms[pass];
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "common.hpp"
+
+#include <vector>
+
+// Times render passes on the GPU with GL_TIME_ELAPSED queries
+//
+// Queries come from a pool and are read back FRAMES_IN_FLIGHT frames after they were issued,
+// once the GPU is long done with them, so reading never stalls the pipeline. A pass can be timed
+// several times in a frame, its times add up. Only one GL_TIME_ELAPSED query can be running at
+// once: begin() and end() pairs must not nest.
+class GpuTimer
+{
+public:
+    GpuTimer();
+
+    // Times pass_count passes, numbered from 0
+    bool init(size_t pass_count);
+
+    void destroy();
+
+    // Reads back the oldest frame still in flight, call once per frame before the first begin()
+    void begin_frame();
+
+    void begin(size_t pass);
+    void end();
+
+    // GPU milliseconds of the pass per frame, averaged over the last frames read back
+    float get_ms(size_t pass) const;
+
+private:
+    struct Query {
+        size_t pass;
+        GLuint id;
+    };
+
+    std::vector<std::vector<Query>> m_frames; // issued queries, one list per frame in flight
+    size_t m_frame;
+    std::vector<GLuint> m_free;
+    std::vector<GLuint64> m_frame_ns; // per pass, for the frame being read back
+    std::vector<float> m_ms;
+};
@@ -1,26 +1,60 @@
 // internal
 #include "common.hpp"
 #include "world.hpp"
-
-#define GL3W_IMPLEMENTATION
-#include <gl3w.h>
+#include "glfw_platform.hpp"
+#include "profiler.hpp"
 
 // stlib
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 using Clock = std::chrono::high_resolution_clock;
 
 // Global 
 World world;
+GlfwWindow window;
+SdlAudio audio;
 const int width = 1200;
 const int height = 800;
 
+// Updates per second, independent from the refresh rate. Can be set on the command line.
+const float DEFAULT_TICK_RATE = 60.f;
+
+// Updates run in a single frame at most when catching up. Past that the game slows down rather
+// than spending ever longer frames simulating.
+const int MAX_TICKS_PER_FRAME = 5;
+
 // Entry point
+// Usage: salmon [tick rate] [--record file | --replay file]
+// A replay steps as it was recorded whatever the tick rate, and quits once it is over.
 int main(int argc, char* argv[])
 {
+	float tick_rate = DEFAULT_TICK_RATE;
+	const char* record_path = nullptr;
+	const char* replay_path = nullptr;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+			record_path = argv[++i];
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+			replay_path = argv[++i];
+		else
+			tick_rate = (float)std::atof(argv[i]);
+	}
+	if (tick_rate <= 0.f)
+		tick_rate = DEFAULT_TICK_RATE;
+	const float tick_ms = 1000.f / tick_rate;
+
 	// Initializing world (after renderer.init().. sorry)
-	if (!world.init({ (float)width, (float)height }))
+	bool initialized = world.init({ (float)width, (float)height }, window, audio);
+	if (initialized && record_path != nullptr)
+		initialized = world.record(record_path);
+	if (initialized && replay_path != nullptr)
+		initialized = world.replay(replay_path);
+	if (!initialized)
 	{
 		// Time to read the error message
 		std::cout << "Press any key to exit" << std::endl;
@@ -28,21 +62,40 @@ int main(int argc, char* argv[])
 		return EXIT_FAILURE;
 	}
 
+	Profiler::set_thread_name("game");
+
 	auto t = Clock::now();
+	float accumulated_ms = 0.f;
 
-	// variable timestep loop.. can be improved (:
+	// Fixed timestep loop, the world always steps by tick_ms and is drawn in between
 	while (!world.is_over())
 	{
+		PROFILE_ZONE("frame");
+
 		// Processes system messages, if this wasn't present the window would become unresponsive
-		glfwPollEvents();
+		ProfileZone events_zone("poll events");
+		window.poll_events();
+		events_zone.end();
 
 		// Calculating elapsed times in milliseconds from the previous iteration
 		auto now = Clock::now();
 		float elapsed_sec = (float)(std::chrono::duration_cast<std::chrono::microseconds>(now - t)).count() / 1000;
 		t = now;
 
-		world.update(elapsed_sec);
-		world.draw();
+		accumulated_ms += elapsed_sec;
+		int ticks = 0;
+		while (accumulated_ms >= tick_ms && ticks < MAX_TICKS_PER_FRAME && !world.is_over())
+		{
+			world.update(tick_ms);
+			accumulated_ms -= tick_ms;
+			++ticks;
+		}
+
+		// Too far behind, the time that couldn't be simulated is dropped
+		if (accumulated_ms >= tick_ms)
+			accumulated_ms = std::fmod(accumulated_ms, tick_ms);
+
+		world.draw(accumulated_ms / tick_ms);
 	}
 
 	world.destroy();
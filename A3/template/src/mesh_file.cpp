@@ -0,0 +1,206 @@
+// Header
+#include "mesh_file.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(MeshFileHeader) % 4 == 0 && sizeof(Vertex) % 4 == 0, "mesh file arrays must stay aligned");
+
+MeshBounds compute_mesh_bounds(const Vertex* vertices, size_t count) {
+    MeshBounds bounds = {};
+    for (size_t i = 0; i < count; ++i) {
+        vec2 p = { vertices[i].position.x, vertices[i].position.y };
+        if (i == 0) {
+            bounds = { p, p, p, p, p, p };
+            continue;
+        }
+
+        if (p.x < bounds.min.x)
+            bounds.min_x_vertex = p;
+        if (p.x > bounds.max.x)
+            bounds.max_x_vertex = p;
+        if (p.y < bounds.min.y)
+            bounds.min_y_vertex = p;
+        if (p.y > bounds.max.y)
+            bounds.max_y_vertex = p;
+        bounds.min = { bounds.min_x_vertex.x, bounds.min_y_vertex.y };
+        bounds.max = { bounds.max_x_vertex.x, bounds.max_y_vertex.y };
+    }
+    return bounds;
+}
+
+bool read_text_mesh(const char* path, std::vector<Vertex>& vertices, std::vector<uint16_t>& indices) {
+    vertices.clear();
+    indices.clear();
+
+    FILE* mesh_file = fopen(path, "r");
+    if (mesh_file == nullptr) {
+        fprintf(stderr, "Failed to open mesh %s\n", path);
+        return false;
+    }
+
+    bool ok = true;
+    size_t num_vertices = 0;
+    if (fscanf(mesh_file, "%zu\n", &num_vertices) != 1)
+        ok = false;
+    for (size_t i = 0; ok && i < num_vertices; ++i) {
+        float x, y, z;
+        float _u[3]; // unused
+        int r, g, b;
+        if (fscanf(mesh_file, "%f %f %f %f %f %f %d %d %d\n", &x, &y, &z, _u, _u + 1, _u + 2, &r, &g, &b) != 9) {
+            ok = false;
+            break;
+        }
+        Vertex vertex;
+        vertex.position = { x, y, -z };
+        vertex.color = { (float) r / 255, (float) g / 255, (float) b / 255 };
+        vertices.push_back(vertex);
+    }
+
+    size_t num_indices = 0;
+    if (ok && fscanf(mesh_file, "%zu\n", &num_indices) != 1)
+        ok = false;
+    for (size_t i = 0; ok && i < num_indices; ++i) {
+        int idx[3];
+        if (fscanf(mesh_file, "%d %d %d\n", idx, idx + 1, idx + 2) != 3) {
+            ok = false;
+            break;
+        }
+        indices.push_back((uint16_t) idx[0]);
+        indices.push_back((uint16_t) idx[1]);
+        indices.push_back((uint16_t) idx[2]);
+    }
+
+    fclose(mesh_file);
+    if (!ok)
+        fprintf(stderr, "Malformed mesh %s\n", path);
+    return ok;
+}
+
+bool write_mesh_file(const char* path, const std::vector<Vertex>& vertices, const std::vector<uint16_t>& indices) {
+    MeshFileHeader header;
+    header.magic = MESH_FILE_MAGIC;
+    header.version = MESH_FILE_VERSION;
+    header.vertex_count = (uint32_t) vertices.size();
+    header.index_count = (uint32_t) indices.size();
+    header.bounds = compute_mesh_bounds(vertices.data(), vertices.size());
+
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        fprintf(stderr, "Failed to create %s\n", path);
+        return false;
+    }
+
+    // Pads the indices to a multiple of 4 bytes, so that files can be appended to each other
+    uint16_t padding = 0;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(vertices.data(), sizeof(Vertex), vertices.size(), file) == vertices.size() &&
+              fwrite(indices.data(), sizeof(uint16_t), indices.size(), file) == indices.size() &&
+              (indices.size() % 2 == 0 || fwrite(&padding, sizeof(padding), 1, file) == 1);
+    ok = fclose(file) == 0 && ok;
+
+    if (!ok)
+        fprintf(stderr, "Failed to write %s\n", path);
+    return ok;
+}
+
+MappedMeshFile::MappedMeshFile() : m_data(nullptr), m_size(0) {
+#ifdef _WIN32
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = nullptr;
+#endif
+}
+
+MappedMeshFile::~MappedMeshFile() {
+    close();
+}
+
+bool MappedMeshFile::open(const char* path) {
+    close();
+
+#ifdef _WIN32
+    m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER size;
+    if (m_file != INVALID_HANDLE_VALUE && GetFileSizeEx(m_file, &size) && size.QuadPart > 0) {
+        m_size = (size_t) size.QuadPart;
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping != nullptr)
+            m_data = (const uint8_t*) MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+#else
+    int fd = ::open(path, O_RDONLY);
+    struct stat info;
+    if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* data = mmap(nullptr, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            m_data = (const uint8_t*) data;
+            m_size = (size_t) info.st_size;
+        }
+    }
+    // The mapping keeps the file alive
+    if (fd >= 0)
+        ::close(fd);
+#endif
+
+    if (m_data == nullptr) {
+        fprintf(stderr, "Failed to map mesh %s\n", path);
+        close();
+        return false;
+    }
+
+    bool valid = m_size >= sizeof(MeshFileHeader);
+    if (valid) {
+        const MeshFileHeader& header = get_header();
+        size_t expected = sizeof(MeshFileHeader) + header.vertex_count * sizeof(Vertex) +
+                          header.index_count * sizeof(uint16_t);
+        valid = header.magic == MESH_FILE_MAGIC && header.version == MESH_FILE_VERSION && m_size >= expected;
+    }
+    if (!valid) {
+        fprintf(stderr, "%s is not a version %u mesh file, convert it again with mesh_convert\n",
+                path, MESH_FILE_VERSION);
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedMeshFile::close() {
+#ifdef _WIN32
+    if (m_data != nullptr)
+        UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr)
+        CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = nullptr;
+#else
+    if (m_data != nullptr)
+        munmap((void*) m_data, m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+const MeshFileHeader& MappedMeshFile::get_header() const {
+    return *(const MeshFileHeader*) m_data;
+}
+
+const Vertex* MappedMeshFile::get_vertices() const {
+    return (const Vertex*) (m_data + sizeof(MeshFileHeader));
+}
+
+const uint16_t* MappedMeshFile::get_indices() const {
+    return (const uint16_t*) (m_data + sizeof(MeshFileHeader) + get_header().vertex_count * sizeof(Vertex));
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "common.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Binary meshes, converted at build time from the text .mesh files by tools/mesh_convert
+//
+// The file is the header followed by the vertices exactly as they go in the vertex buffer and
+// then the indices, three per triangle. Everything is 4 byte aligned and in the byte order of
+// the machine that converted it, so the loader maps the file and hands both arrays straight to
+// glBufferData without parsing or copying anything.
+
+const uint32_t MESH_FILE_MAGIC = 0x48534d53; // "SMSH"
+const uint32_t MESH_FILE_VERSION = 1;
+
+// Extremes of the vertex positions, the first vertex found wins ties
+struct MeshBounds {
+    vec2 min;
+    vec2 max;
+    vec2 min_x_vertex; // salmon mouth
+    vec2 max_x_vertex; // salmon tail
+    vec2 min_y_vertex;
+    vec2 max_y_vertex;
+};
+
+struct MeshFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertex_count; // Vertex
+    uint32_t index_count; // uint16_t
+    MeshBounds bounds;
+};
+
+MeshBounds compute_mesh_bounds(const Vertex* vertices, size_t count);
+
+// Parses a text mesh: the vertex count, a line of position, normal and 0-255 colour per vertex,
+// the triangle count and a line of three indices per triangle. z is flipped and the colour
+// scaled to 0-1, the way the salmon shader expects them.
+bool read_text_mesh(const char* path, std::vector<Vertex>& vertices, std::vector<uint16_t>& indices);
+
+bool write_mesh_file(const char* path, const std::vector<Vertex>& vertices, const std::vector<uint16_t>& indices);
+
+// Read only mapping of a binary mesh, the arrays are valid until close()
+class MappedMeshFile
+{
+public:
+    MappedMeshFile();
+    ~MappedMeshFile();
+
+    // Maps the file and checks its header against its size
+    bool open(const char* path);
+
+    void close();
+
+    const MeshFileHeader& get_header() const;
+    const Vertex* get_vertices() const;
+    const uint16_t* get_indices() const;
+
+private:
+    MappedMeshFile(const MappedMeshFile&);
+    MappedMeshFile& operator=(const MappedMeshFile&);
+
+    const uint8_t* m_data;
+    size_t m_size;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#endif
+};
@@ -0,0 +1,205 @@
+// Header
+#include "nav_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Off screen margins the fish and turtles can path through
+    const float X_MARGIN = 200.f;
+    const float FISH_Y_MARGIN = 75.f;
+    const float TURTLE_Y_MARGIN = 100.f;
+
+    // Padding around the salmon's bounding box, in mesh units
+    const float SALMON_PADDING = 0.25f;
+}
+
+bool NavGrid::init(vec2 level_bounds, float cell_size) {
+    m_x_bounds = {-X_MARGIN, level_bounds.x + X_MARGIN};
+    m_fish_y_bounds = {-FISH_Y_MARGIN, level_bounds.y + FISH_Y_MARGIN};
+    m_turtle_y_bounds = {-TURTLE_Y_MARGIN, level_bounds.y + TURTLE_Y_MARGIN};
+
+    m_origin = {m_x_bounds.x, m_turtle_y_bounds.x};
+    m_cell_size = cell_size;
+    m_width = (int) std::ceil((m_x_bounds.y - m_x_bounds.x) / cell_size) + 1;
+    m_height = (int) std::ceil((m_turtle_y_bounds.y - m_turtle_y_bounds.x) / cell_size) + 1;
+
+    size_t words = ((size_t) m_width * m_height + 63) / 64;
+    m_blocked.assign(words, 0);
+    m_edges.assign(words, 0);
+    m_obstacles.clear();
+    m_version = 0;
+
+    return true;
+}
+
+void NavGrid::destroy() {
+    m_obstacles.clear();
+    std::fill(m_blocked.begin(), m_blocked.end(), 0);
+    std::fill(m_edges.begin(), m_edges.end(), 0);
+    ++m_version;
+}
+
+void NavGrid::set_obstacle(int id, vec2 min, vec2 max) {
+    if ((int) m_obstacles.size() <= id) {
+        Obstacle none;
+        none.active = false;
+        m_obstacles.resize(id + 1, none);
+    }
+
+    Obstacle& obstacle = m_obstacles[id];
+    if (obstacle.active && obstacle.min.x == min.x && obstacle.min.y == min.y &&
+        obstacle.max.x == max.x && obstacle.max.y == max.y)
+        return;
+
+    int old_range[4];
+    bool was_active = obstacle.active;
+    std::copy(obstacle.cells, obstacle.cells + 4, old_range);
+
+    obstacle.min = min;
+    obstacle.max = max;
+    obstacle.active = true;
+    cell_range(min, max, obstacle.cells);
+
+    // Only the cells the obstacle leaves or enters are dirty
+    if (was_active)
+        rasterise(old_range);
+    rasterise(obstacle.cells);
+    ++m_version;
+}
+
+void NavGrid::remove_obstacle(int id) {
+    if (id >= (int) m_obstacles.size() || !m_obstacles[id].active)
+        return;
+
+    m_obstacles[id].active = false;
+    rasterise(m_obstacles[id].cells);
+    ++m_version;
+}
+
+void NavGrid::set_salmon(Salmon& salmon) {
+    vec2 salmon_pos = salmon.get_position();
+    vec2 salmon_scale = salmon.get_scale();
+    vec2 salmon_x_bounds = {salmon.get_x_bounds().x - SALMON_PADDING, salmon.get_x_bounds().y + SALMON_PADDING};
+    vec2 salmon_y_bounds = {salmon.get_y_bounds().x - SALMON_PADDING, salmon.get_y_bounds().y + SALMON_PADDING};
+
+    vec2 min = {salmon_pos.x + salmon_x_bounds.x * std::abs(salmon_scale.x),
+                salmon_pos.y + salmon_y_bounds.x * std::abs(salmon_scale.y)};
+    vec2 max = {salmon_pos.x + salmon_x_bounds.y * std::abs(salmon_scale.x),
+                salmon_pos.y + salmon_y_bounds.y * std::abs(salmon_scale.y)};
+
+    set_obstacle(SALMON, min, max);
+}
+
+bool NavGrid::is_free(vec2 position) const {
+    // Outside of the grid every obstacle is tested
+    int x, y;
+    if (get_cell(position, x, y)) {
+        int cell = y * m_width + x;
+        if (test_bit(m_blocked, cell))
+            return false;
+        if (!test_bit(m_edges, cell))
+            return true;
+    }
+
+    for (auto& obstacle : m_obstacles) {
+        if (obstacle.active &&
+            position.x > obstacle.min.x && position.x < obstacle.max.x &&
+            position.y > obstacle.min.y && position.y < obstacle.max.y)
+            return false;
+    }
+    return true;
+}
+
+bool NavGrid::fish_can_enter(vec2 position) const {
+    if (position.x < m_x_bounds.x || position.x > m_x_bounds.y ||
+        position.y < m_fish_y_bounds.x || position.y > m_fish_y_bounds.y)
+        return false;
+
+    return is_free(position);
+}
+
+bool NavGrid::turtle_can_enter(vec2 position) const {
+    return !(position.x < m_x_bounds.x || position.x > m_x_bounds.y ||
+             position.y < m_turtle_y_bounds.x || position.y > m_turtle_y_bounds.y);
+}
+
+int NavGrid::get_width() const {
+    return m_width;
+}
+
+int NavGrid::get_height() const {
+    return m_height;
+}
+
+vec2 NavGrid::get_cell_center(int x, int y) const {
+    return {m_origin.x + (x + 0.5f) * m_cell_size, m_origin.y + (y + 0.5f) * m_cell_size};
+}
+
+float NavGrid::get_cell_size() const {
+    return m_cell_size;
+}
+
+bool NavGrid::get_cell(vec2 position, int& x, int& y) const {
+    x = (int) std::floor((position.x - m_origin.x) / m_cell_size);
+    y = (int) std::floor((position.y - m_origin.y) / m_cell_size);
+    return x >= 0 && y >= 0 && x < m_width && y < m_height;
+}
+
+unsigned int NavGrid::get_version() const {
+    return m_version;
+}
+
+// A cell is considered slightly larger than it is so that positions rounded into a
+// neighbouring cell are still classified correctly.
+bool NavGrid::overlaps_cell(const Obstacle& obstacle, int x, int y, bool& covers) const {
+    float epsilon = m_cell_size * 0.001f;
+    float x0 = m_origin.x + x * m_cell_size - epsilon;
+    float y0 = m_origin.y + y * m_cell_size - epsilon;
+    float x1 = x0 + m_cell_size + 2 * epsilon;
+    float y1 = y0 + m_cell_size + 2 * epsilon;
+
+    covers = x0 > obstacle.min.x && x1 < obstacle.max.x && y0 > obstacle.min.y && y1 < obstacle.max.y;
+    return x1 > obstacle.min.x && x0 < obstacle.max.x && y1 > obstacle.min.y && y0 < obstacle.max.y;
+}
+
+void NavGrid::cell_range(vec2 min, vec2 max, int range[4]) const {
+    range[0] = std::max(0, (int) std::floor((min.x - m_origin.x) / m_cell_size) - 1);
+    range[1] = std::max(0, (int) std::floor((min.y - m_origin.y) / m_cell_size) - 1);
+    range[2] = std::min(m_width - 1, (int) std::floor((max.x - m_origin.x) / m_cell_size) + 1);
+    range[3] = std::min(m_height - 1, (int) std::floor((max.y - m_origin.y) / m_cell_size) + 1);
+}
+
+void NavGrid::rasterise(const int range[4]) {
+    for (int y = range[1]; y <= range[3]; ++y) {
+        for (int x = range[0]; x <= range[2]; ++x) {
+            bool blocked = false;
+            bool edge = false;
+
+            for (auto& obstacle : m_obstacles) {
+                bool covers;
+                if (obstacle.active && overlaps_cell(obstacle, x, y, covers)) {
+                    blocked |= covers;
+                    edge |= !covers;
+                }
+            }
+
+            int cell = y * m_width + x;
+            set_bit(m_blocked, cell, blocked);
+            set_bit(m_edges, cell, edge && !blocked);
+        }
+    }
+}
+
+bool NavGrid::test_bit(const std::vector<uint64_t>& bits, int cell) const {
+    return (bits[cell >> 6] >> (cell & 63)) & 1u;
+}
+
+void NavGrid::set_bit(std::vector<uint64_t>& bits, int cell, bool value) {
+    uint64_t mask = (uint64_t) 1 << (cell & 63);
+    if (value)
+        bits[cell >> 6] |= mask;
+    else
+        bits[cell >> 6] &= ~mask;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "common.hpp"
+#include "salmon.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Occupancy grid shared by all the pathfinders
+//
+// Obstacles are axis aligned boxes that are rasterised into two bitsets: cells that lie
+// entirely inside an obstacle are blocked, cells crossed by the border of an obstacle are
+// edges and fall back to an exact test against the few obstacles. Moving an obstacle only
+// re-rasterises the cells it used to cover and the ones it covers now.
+class NavGrid
+{
+public:
+    // Obstacle ids
+    enum { SALMON = 0 };
+
+    // Covers the level and the off screen area the AI is allowed to path through
+    bool init(vec2 level_bounds, float cell_size);
+
+    // Releases all the obstacles
+    void destroy();
+
+    // Adds or moves the obstacle with the given id, points strictly inside (min, max) are blocked
+    void set_obstacle(int id, vec2 min, vec2 max);
+    void remove_obstacle(int id);
+
+    // Blocks the salmon's padded bounding box
+    void set_salmon(Salmon& salmon);
+
+    // True if no obstacle covers the position
+    bool is_free(vec2 position) const;
+
+    // True if a fish (resp. turtle) may path through the position
+    bool fish_can_enter(vec2 position) const;
+    bool turtle_can_enter(vec2 position) const;
+
+    // Grid layout, cells are indexed row by row
+    int get_width() const;
+    int get_height() const;
+    vec2 get_cell_center(int x, int y) const;
+    float get_cell_size() const;
+
+    // Returns false if the position is outside of the grid
+    bool get_cell(vec2 position, int& x, int& y) const;
+
+    // Incremented every time an obstacle is added, moved or removed
+    unsigned int get_version() const;
+
+private:
+    struct Obstacle {
+        vec2 min;
+        vec2 max;
+        int cells[4]; // x0, y0, x1, y1 of the rasterised range, inclusive
+        bool active;
+    };
+
+    bool overlaps_cell(const Obstacle& obstacle, int x, int y, bool& covers) const;
+    void cell_range(vec2 min, vec2 max, int range[4]) const;
+    void rasterise(const int range[4]);
+    bool test_bit(const std::vector<uint64_t>& bits, int cell) const;
+    void set_bit(std::vector<uint64_t>& bits, int cell, bool value);
+
+    vec2 m_origin;
+    float m_cell_size;
+    int m_width;
+    int m_height;
+    unsigned int m_version;
+
+    vec2 m_x_bounds;
+    vec2 m_fish_y_bounds;
+    vec2 m_turtle_y_bounds;
+
+    std::vector<Obstacle> m_obstacles;
+    std::vector<uint64_t> m_blocked;
+    std::vector<uint64_t> m_edges;
+};
@@ -0,0 +1,152 @@
+// Header
+#include "null_gl.hpp"
+
+#include "common.hpp"
+
+#include <vector>
+
+namespace
+{
+    GLuint next_name = 1;
+    std::vector<char> mapped;
+
+    // Does nothing and returns 0, GL_NO_ERROR or GL_FALSE depending on the entry point
+    template <typename R, typename... Args>
+    struct Ignore {
+        static R APIENTRY call(Args...) { return R(); }
+    };
+
+    template <typename R, typename... Args>
+    void ignore(R (APIENTRY *&proc)(Args...)) {
+        proc = &Ignore<R, Args...>::call;
+    }
+
+    void APIENTRY gen_names(GLsizei n, GLuint* names) {
+        for (GLsizei i = 0; i < n; ++i)
+            names[i] = next_name++;
+    }
+
+    GLuint APIENTRY create_name() {
+        return next_name++;
+    }
+
+    GLuint APIENTRY create_shader(GLenum) {
+        return next_name++;
+    }
+
+    // Compile and link status are the only queries the game makes that have to succeed, every
+    // other one answers 0 (empty info log, empty buffer)
+    void APIENTRY get_status(GLuint, GLenum pname, GLint* params) {
+        *params = (pname == GL_COMPILE_STATUS || pname == GL_LINK_STATUS) ? GL_TRUE : 0;
+    }
+
+    // GL 0.0 without extensions or program binary formats, so the program cache stays off
+    void APIENTRY get_integer(GLenum, GLint* data) {
+        *data = 0;
+    }
+
+    void APIENTRY get_buffer_parameter(GLenum, GLenum, GLint* params) {
+        *params = 0;
+    }
+
+    // Timer queries are always available and measure nothing
+    void APIENTRY get_query_object(GLuint, GLenum pname, GLint* params) {
+        *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+    }
+
+    void APIENTRY get_query_object_ui64(GLuint, GLenum, GLuint64* params) {
+        *params = 0;
+    }
+
+    GLenum APIENTRY check_framebuffer_status(GLenum) {
+        return GL_FRAMEBUFFER_COMPLETE;
+    }
+
+    void* APIENTRY map_buffer_range(GLenum, GLintptr, GLsizeiptr length, GLbitfield) {
+        if (mapped.size() < (size_t) length)
+            mapped.resize((size_t) length);
+        return mapped.data();
+    }
+
+    GLboolean APIENTRY unmap_buffer(GLenum) {
+        return GL_TRUE;
+    }
+}
+
+void null_gl_init() {
+    ignore(glActiveTexture);
+    ignore(glAttachShader);
+    ignore(glBeginQuery);
+    ignore(glBindBuffer);
+    ignore(glBindFramebuffer);
+    ignore(glBindRenderbuffer);
+    ignore(glBindTexture);
+    ignore(glBindVertexArray);
+    ignore(glBlendFunc);
+    ignore(glBufferData);
+    ignore(glClear);
+    ignore(glClearColor);
+    ignore(glClearDepth);
+    ignore(glCompileShader);
+    ignore(glDeleteBuffers);
+    ignore(glDeleteFramebuffers);
+    ignore(glDeleteProgram);
+    ignore(glDeleteQueries);
+    ignore(glDeleteRenderbuffers);
+    ignore(glDeleteShader);
+    ignore(glDeleteTextures);
+    ignore(glDeleteVertexArrays);
+    ignore(glDepthRange);
+    ignore(glDisable);
+    ignore(glDisableVertexAttribArray);
+    ignore(glDrawArrays);
+    ignore(glDrawArraysInstanced);
+    ignore(glDrawBuffers);
+    ignore(glDrawElements);
+    ignore(glDrawElementsInstanced);
+    ignore(glEnable);
+    ignore(glEnableVertexAttribArray);
+    ignore(glEndQuery);
+    ignore(glFramebufferRenderbuffer);
+    ignore(glFramebufferTexture);
+    ignore(glGetAttribLocation);
+    ignore(glGetError);
+    ignore(glGetProgramInfoLog);
+    ignore(glGetShaderInfoLog);
+    ignore(glGetUniformLocation);
+    ignore(glLineWidth);
+    ignore(glLinkProgram);
+    ignore(glPointSize);
+    ignore(glRenderbufferStorage);
+    ignore(glShaderSource);
+    ignore(glTexImage2D);
+    ignore(glTexParameteri);
+    ignore(glUniform1f);
+    ignore(glUniform1i);
+    ignore(glUniform1iv);
+    ignore(glUniform2f);
+    ignore(glUniform3fv);
+    ignore(glUniformMatrix3fv);
+    ignore(glUseProgram);
+    ignore(glVertexAttribDivisor);
+    ignore(glVertexAttribPointer);
+    ignore(glViewport);
+
+    glGenBuffers = gen_names;
+    glGenFramebuffers = gen_names;
+    glGenQueries = gen_names;
+    glGenRenderbuffers = gen_names;
+    glGenTextures = gen_names;
+    glGenVertexArrays = gen_names;
+    glCreateProgram = create_name;
+    glCreateShader = create_shader;
+    glGetShaderiv = get_status;
+    glGetProgramiv = get_status;
+    glGetBufferParameteriv = get_buffer_parameter;
+    glGetIntegerv = get_integer;
+    glGetQueryObjectiv = get_query_object;
+    glGetQueryObjectui64v = get_query_object_ui64;
+    glCheckFramebufferStatus = check_framebuffer_status;
+    glMapBufferRange = map_buffer_range;
+    glUnmapBuffer = unmap_buffer;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// Points the GL entry points used by the game at functions that do nothing, in place of
+// gl3w_init(), so that the game code runs without a context. Names are handed out, shaders
+// compile and link, mapped buffers are scratch memory and nothing is ever drawn.
+// An entry point missing from null_gl.cpp is still null and crashes on its first call.
+void null_gl_init();
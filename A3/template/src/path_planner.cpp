@@ -0,0 +1,135 @@
+// Header
+#include "path_planner.hpp"
+
+#include "profiler.hpp"
+
+namespace
+{
+    // Distance between two turtle waypoints
+    const float TURTLE_STEP = 50.f;
+}
+
+PathPlanner::PathPlanner() : m_running(false), m_has_pending(false), m_planning(false), m_front(0), m_ready(false) {
+}
+
+bool PathPlanner::init(const NavGrid& nav_grid, float exit_x) {
+    for (auto& result : m_results) {
+        if (!result.flow_field.init(nav_grid, exit_x))
+            return false;
+        result.fish_paths.clear();
+        result.turtle_path.clear();
+        result.has_turtle = false;
+    }
+    m_turtle_path.clear();
+
+    m_front = 0;
+    m_ready = false;
+    m_has_pending = false;
+    m_planning = false;
+    m_running = true;
+    m_thread = std::thread(&PathPlanner::run, this);
+    return true;
+}
+
+void PathPlanner::destroy() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+        m_has_pending = false;
+    }
+    m_wakeup.notify_one();
+
+    if (m_thread.joinable())
+        m_thread.join();
+
+    for (auto& result : m_results)
+        result.flow_field.destroy();
+}
+
+void PathPlanner::post(const Snapshot& snapshot) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        bool plan_turtle = m_has_pending && m_pending.plan_turtle;
+        m_pending = snapshot;
+        m_pending.plan_turtle = m_pending.plan_turtle || plan_turtle;
+        m_has_pending = true;
+    }
+    m_wakeup.notify_one();
+}
+
+void PathPlanner::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_wakeup.wait(lock, [this] { return !m_running || (!m_has_pending && !m_planning); });
+}
+
+bool PathPlanner::poll() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_ready)
+            return false;
+
+        m_front = 1 - m_front;
+        m_ready = false;
+    }
+    m_wakeup.notify_one();
+    return true;
+}
+
+const PathPlanner::Result& PathPlanner::get_result() const {
+    return m_results[m_front];
+}
+
+void PathPlanner::run() {
+    Profiler::set_thread_name("path planner");
+    Snapshot snapshot;
+
+    while (true) {
+        int back;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            // The back buffer can only be reused once the game thread picked up the last result
+            m_wakeup.wait(lock, [this] { return !m_running || (m_has_pending && !m_ready); });
+            if (!m_running)
+                return;
+
+            std::swap(snapshot, m_pending);
+            m_has_pending = false;
+            m_planning = true;
+            back = 1 - m_front;
+        }
+
+        plan(snapshot, m_results[back]);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_ready = true;
+            m_planning = false;
+        }
+        // Only wait() can be waiting on the game thread
+        m_wakeup.notify_one();
+    }
+}
+
+void PathPlanner::plan(const Snapshot& snapshot, Result& result) {
+    PROFILE_ZONE("plan");
+    result.flow_field.update(snapshot.nav_grid);
+
+    result.fish_paths.resize(snapshot.fish_positions.size());
+    for (size_t i = 0; i < snapshot.fish_positions.size(); ++i)
+        result.flow_field.trace(snapshot.fish_positions[i], result.fish_paths[i]);
+
+    result.has_turtle = snapshot.has_turtle && snapshot.plan_turtle;
+    if (!snapshot.has_turtle) {
+        m_turtle_path.clear();
+    } else if (snapshot.plan_turtle) {
+        const NavGrid& nav_grid = snapshot.nav_grid;
+        auto walkable = [&nav_grid](vec2 position) {
+            return nav_grid.turtle_can_enter(position);
+        };
+
+        m_turtle_path.clear();
+        m_pathfinder.find_path(snapshot.turtle_position, snapshot.salmon_position, TURTLE_STEP, walkable, nullptr,
+                               m_turtle_path);
+    }
+    result.turtle_path = m_turtle_path;
+}
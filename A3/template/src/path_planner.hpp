@@ -0,0 +1,89 @@
+#pragma once
+
+#include "common.hpp"
+#include "nav_grid.hpp"
+#include "flow_field.hpp"
+#include "pathfinder.hpp"
+
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Plans the fish and turtle paths on a background thread
+//
+// The world posts a snapshot of the grid and of the entity positions, the planner thread
+// builds the fish flow field and the turtle path from it and publishes them into the back
+// half of a double buffer. poll() swaps the halves on the game thread, so the results can be
+// read without locking until the next poll(). Only the latest snapshot is kept: a snapshot
+// still waiting when a newer one is posted is dropped, and the planner waits for the last
+// result to be picked up before starting on the next one.
+//
+// The flow field is rebuilt from every snapshot. The turtle A* costs more and only runs for the
+// snapshots that ask for it, the others keep the last turtle path.
+class PathPlanner
+{
+public:
+    // Copied from the world when a plan is requested
+    struct Snapshot {
+        NavGrid nav_grid;
+        vec2 salmon_position;
+        std::vector<vec2> fish_positions;
+        bool has_turtle;
+        vec2 turtle_position;
+        bool plan_turtle; // run the turtle A*, or keep the last path
+    };
+
+    // Built by the planner thread from a snapshot
+    struct Result {
+        FlowField flow_field;
+        std::vector<std::list<vec2>> fish_paths; // traced through the field, for debugging
+        std::list<vec2> turtle_path; // the last one planned, for debugging
+        bool has_turtle; // turtle_path was planned from this snapshot
+    };
+
+    PathPlanner();
+
+    // Starts the planner thread
+    bool init(const NavGrid& nav_grid, float exit_x);
+
+    // Waits for the planner thread to finish, pending snapshots are dropped
+    void destroy();
+
+    // Queues a snapshot, replacing the one still waiting if any. A turtle plan asked for by the
+    // replaced snapshot is still run.
+    void post(const Snapshot& snapshot);
+
+    // Blocks until the snapshot posted last is planned, so that the next poll() picks it up.
+    // Makes the results land on the same update every run, for recorded and replayed games.
+    void wait();
+
+    // Makes the latest finished result current, returns true if there was a new one
+    bool poll();
+
+    // Current result, only changes on poll()
+    const Result& get_result() const;
+
+private:
+    void run();
+    void plan(const Snapshot& snapshot, Result& result);
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    bool m_running;
+
+    Snapshot m_pending;
+    bool m_has_pending;
+    bool m_planning;
+
+    // The game thread owns m_results[m_front], the planner thread the other one until m_ready is set
+    Result m_results[2];
+    int m_front;
+    bool m_ready;
+
+    // Only used by the planner thread
+    Pathfinder m_pathfinder;
+    std::list<vec2> m_turtle_path;
+};
@@ -0,0 +1,268 @@
+// Header
+#include "pathfinder.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const size_t INITIAL_NODES = 1024;
+
+    // Cells expanded before giving up on a goal that cannot be reached. Reopened cells make the
+    // search go on forever otherwise.
+    const size_t MAX_EXPANDED = 1024;
+}
+
+Pathfinder::Pathfinder() : m_step(1.f), m_avoid(false), m_slots_used(0) {
+    m_nodes.reserve(INITIAL_NODES);
+    m_heap.reserve(INITIAL_NODES);
+    m_closed.reserve(INITIAL_NODES);
+    m_stack.reserve(INITIAL_NODES);
+}
+
+void Pathfinder::find_path(vec2 start, vec2 goal, float step, const Walkable& walkable, const vec2* avoid,
+                           std::list<vec2>& path) {
+    m_origin = start;
+    m_goal = goal;
+    m_step = step;
+    m_avoid = avoid != nullptr;
+    reset(INITIAL_NODES);
+
+    heap_push(add_node(start, goal, avoid));
+
+    // Successors are generated in this order, which decides ties
+    float x_pos[3] = {-step, 0, step};
+    float y_pos[9] = {step, step, step, 0, 0, 0, -step, -step, -step};
+
+    vec2 last_expanded = start;
+    while (!m_heap.empty() && m_closed.size() < MAX_EXPANDED) {
+        int cur = pick_cheapest(last_expanded);
+        heap_remove(cur);
+        m_nodes[cur].state = EXPANDING;
+
+        vec2 position = m_nodes[cur].position;
+        if (len(sub(goal, position)) <= step)
+            break;
+
+        for (int i = 0; i < 9; i++) {
+            float x = x_pos[i % 3] + position.x;
+            float y = y_pos[i] + position.y;
+
+            if (x == position.x && y == position.y)
+                continue;
+
+            vec2 successor = {x, y};
+            if (walkable(successor) && !is_known(successor, last_expanded))
+                heap_push(add_node(successor, goal, avoid));
+        }
+
+        m_nodes[cur].state = CLOSED;
+        m_closed.push_back(cur);
+        last_expanded = position;
+    }
+
+    path.clear();
+    for (int node : m_closed)
+        path.push_back(m_nodes[node].position);
+    path.push_back(goal);
+}
+
+void Pathfinder::reset(size_t expected_nodes) {
+    m_nodes.clear();
+    m_heap.clear();
+    m_closed.clear();
+
+    size_t slots = 1;
+    while (slots < 2 * expected_nodes)
+        slots <<= 1;
+
+    if (m_slot_nodes.size() < slots) {
+        m_slot_keys.resize(slots);
+        m_slot_nodes.resize(slots);
+    }
+    std::fill(m_slot_nodes.begin(), m_slot_nodes.end(), -1);
+    m_slots_used = 0;
+}
+
+int Pathfinder::add_node(vec2 position, vec2 goal, const vec2* avoid) {
+    Node node;
+    node.position = position;
+    node.goal_dist = len(sub(position, goal));
+    node.avoid_dist = avoid != nullptr ? len(sub(*avoid, position)) : 0.f;
+    node.heap_index = -1;
+    node.next_in_cell = -1;
+    node.state = OPEN;
+
+    m_nodes.push_back(node);
+    int index = (int) m_nodes.size() - 1;
+    insert_in_cell(index);
+    return index;
+}
+
+// Linear scan of the open list replaced by a walk of the heap: a subtree is skipped as soon as
+// its root is further from the goal than the best cost found so far, since cost >= goal distance.
+int Pathfinder::pick_cheapest(vec2 last_expanded) {
+    if (m_heap.size() == 1)
+        return m_heap[0];
+
+    int best = -1;
+    float best_cost = 0.f;
+
+    m_stack.clear();
+    m_stack.push_back(0);
+    while (!m_stack.empty()) {
+        int slot = m_stack.back();
+        m_stack.pop_back();
+
+        int node = m_heap[slot];
+        if (best >= 0 && m_nodes[node].goal_dist > best_cost)
+            continue;
+
+        float cost = len(sub(m_nodes[node].position, last_expanded)) + m_nodes[node].goal_dist;
+        if (best < 0 || better(node, cost, best, best_cost)) {
+            best = node;
+            best_cost = cost;
+        }
+
+        size_t child = 2 * (size_t) slot + 1;
+        if (child < m_heap.size())
+            m_stack.push_back((int) child);
+        if (child + 1 < m_heap.size())
+            m_stack.push_back((int) child + 1);
+    }
+
+    return best;
+}
+
+// Lowest cost first, then furthest from the avoided point, then the most recently opened cell
+bool Pathfinder::better(int a, float a_cost, int b, float b_cost) const {
+    if (a_cost != b_cost)
+        return a_cost < b_cost;
+
+    if (m_avoid && m_nodes[a].avoid_dist != m_nodes[b].avoid_dist)
+        return m_nodes[a].avoid_dist > m_nodes[b].avoid_dist;
+
+    return a > b;
+}
+
+// A cell is already known if an open or closed node sits at the same position with a cost
+// that is not higher than the new one
+bool Pathfinder::is_known(vec2 position, vec2 last_expanded) const {
+    size_t slot = find_slot(cell_key(position));
+    if (m_slot_nodes[slot] < 0)
+        return false;
+
+    float cost = len(sub(position, last_expanded)) + len(sub(position, m_goal));
+    for (int node = m_slot_nodes[slot]; node >= 0; node = m_nodes[node].next_in_cell) {
+        const Node& other = m_nodes[node];
+        if (other.state == EXPANDING || len(sub(other.position, position)) >= 0.01)
+            continue;
+
+        if (len(sub(other.position, last_expanded)) + other.goal_dist <= cost)
+            return true;
+    }
+
+    return false;
+}
+
+uint32_t Pathfinder::cell_key(vec2 position) const {
+    long cx = std::lround((position.x - m_origin.x) / m_step);
+    long cy = std::lround((position.y - m_origin.y) / m_step);
+    return ((uint32_t) (uint16_t) cx) | ((uint32_t) (uint16_t) cy << 16);
+}
+
+size_t Pathfinder::find_slot(uint32_t key) const {
+    size_t mask = m_slot_nodes.size() - 1;
+    size_t slot = (key * 2654435761u) & mask;
+    while (m_slot_nodes[slot] >= 0 && m_slot_keys[slot] != key)
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+void Pathfinder::insert_in_cell(int node) {
+    if (2 * (m_slots_used + 1) > m_slot_nodes.size())
+        grow_table();
+
+    uint32_t key = cell_key(m_nodes[node].position);
+    size_t slot = find_slot(key);
+    if (m_slot_nodes[slot] < 0) {
+        m_slot_keys[slot] = key;
+        ++m_slots_used;
+    }
+
+    m_nodes[node].next_in_cell = m_slot_nodes[slot];
+    m_slot_nodes[slot] = node;
+}
+
+void Pathfinder::grow_table() {
+    std::vector<uint32_t> keys;
+    std::vector<int> nodes;
+    keys.swap(m_slot_keys);
+    nodes.swap(m_slot_nodes);
+
+    m_slot_keys.resize(keys.size() * 2);
+    m_slot_nodes.assign(nodes.size() * 2, -1);
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i] >= 0) {
+            size_t slot = find_slot(keys[i]);
+            m_slot_keys[slot] = keys[i];
+            m_slot_nodes[slot] = nodes[i];
+        }
+    }
+}
+
+void Pathfinder::heap_push(int node) {
+    m_heap.push_back(node);
+    m_nodes[node].heap_index = (int) m_heap.size() - 1;
+    heap_sift_up(m_nodes[node].heap_index);
+}
+
+void Pathfinder::heap_remove(int node) {
+    int slot = m_nodes[node].heap_index;
+    int last = (int) m_heap.size() - 1;
+
+    heap_swap(slot, last);
+    m_heap.pop_back();
+    m_nodes[node].heap_index = -1;
+
+    if (slot < last) {
+        heap_sift_up(slot);
+        heap_sift_down(slot);
+    }
+}
+
+void Pathfinder::heap_sift_up(int slot) {
+    while (slot > 0) {
+        int parent = (slot - 1) / 2;
+        if (m_nodes[m_heap[parent]].goal_dist <= m_nodes[m_heap[slot]].goal_dist)
+            break;
+        heap_swap(slot, parent);
+        slot = parent;
+    }
+}
+
+void Pathfinder::heap_sift_down(int slot) {
+    int size = (int) m_heap.size();
+    while (true) {
+        int smallest = slot;
+        int left = 2 * slot + 1;
+        int right = left + 1;
+
+        if (left < size && m_nodes[m_heap[left]].goal_dist < m_nodes[m_heap[smallest]].goal_dist)
+            smallest = left;
+        if (right < size && m_nodes[m_heap[right]].goal_dist < m_nodes[m_heap[smallest]].goal_dist)
+            smallest = right;
+        if (smallest == slot)
+            break;
+
+        heap_swap(slot, smallest);
+        slot = smallest;
+    }
+}
+
+void Pathfinder::heap_swap(int a, int b) {
+    std::swap(m_heap[a], m_heap[b]);
+    m_nodes[m_heap[a]].heap_index = a;
+    m_nodes[m_heap[b]].heap_index = b;
+}
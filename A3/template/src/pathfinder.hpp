@@ -0,0 +1,79 @@
+#pragma once
+
+#include "common.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <vector>
+
+// Grid A* shared by the fish and turtle AI
+//
+// The grid is anchored on the start position and cells are expanded in the 8 compass
+// directions, `step` pixels apart. The next cell to expand is the one minimising
+// (distance to the last expanded cell + distance to the goal), the cost the fish and turtles
+// have always used.
+//
+// Open cells are kept in an indexed binary heap ordered by their distance to the goal. As that
+// distance is a lower bound of the cost, the search for the cheapest open cell only walks the
+// top of the heap. Visited cells are found through an open addressing hash of their grid
+// coordinates and all the storage is kept alive between searches.
+class Pathfinder
+{
+public:
+    // Returns true if the cell centered at the given position can be entered
+    typedef std::function<bool(vec2)> Walkable;
+
+    Pathfinder();
+
+    // Computes a path from start to goal, path is set to the expanded cells followed by the goal.
+    // The search stops early on goals it cannot reach, past a fixed number of expanded cells.
+    // If avoid is not null, ties are broken in favour of the cell furthest away from it.
+    void find_path(vec2 start, vec2 goal, float step, const Walkable& walkable, const vec2* avoid,
+                   std::list<vec2>& path);
+
+private:
+    enum State { OPEN, EXPANDING, CLOSED };
+
+    struct Node {
+        vec2 position;
+        float goal_dist; // heap key
+        float avoid_dist;
+        int heap_index;
+        int next_in_cell; // next node hashed to the same cell, -1 if none
+        State state;
+    };
+
+    void reset(size_t expected_nodes);
+    int add_node(vec2 position, vec2 goal, const vec2* avoid);
+    int pick_cheapest(vec2 last_expanded);
+    bool better(int a, float a_cost, int b, float b_cost) const;
+    bool is_known(vec2 position, vec2 last_expanded) const;
+
+    // Hash of the grid coordinates of a position
+    uint32_t cell_key(vec2 position) const;
+    size_t find_slot(uint32_t key) const;
+    void insert_in_cell(int node);
+    void grow_table();
+
+    // Binary heap on Node::goal_dist
+    void heap_push(int node);
+    void heap_remove(int node);
+    void heap_sift_up(int slot);
+    void heap_sift_down(int slot);
+    void heap_swap(int a, int b);
+
+    vec2 m_origin;
+    vec2 m_goal;
+    float m_step;
+    bool m_avoid;
+
+    std::vector<Node> m_nodes;
+    std::vector<int> m_heap;
+    std::vector<int> m_closed; // in expansion order
+    std::vector<int> m_stack;
+
+    std::vector<uint32_t> m_slot_keys;
+    std::vector<int> m_slot_nodes; // first node of the cell, -1 if the slot is empty
+    size_t m_slots_used;
+};
@@ -0,0 +1,249 @@
+// Header
+#include "pebble_physics.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define PEBBLES_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+    // The gravity of the pebbles was tuned as a velocity change per frame at 60 Hz
+    const float GRAVITY_FRAME_MS = 1000.f / 60.f;
+}
+
+size_t PebbleStore::size() const {
+    return life.size();
+}
+
+bool PebbleStore::empty() const {
+    return life.empty();
+}
+
+void PebbleStore::clear() {
+    life.clear();
+    position_x.clear();
+    position_y.clear();
+    last_position_x.clear();
+    last_position_y.clear();
+    velocity_x.clear();
+    velocity_y.clear();
+    acceleration_x.clear();
+    acceleration_y.clear();
+    radius.clear();
+    can_collide_with_salmon.clear();
+    handles.clear();
+}
+
+void PebbleStore::reserve(size_t count) {
+    life.reserve(count);
+    position_x.reserve(count);
+    position_y.reserve(count);
+    last_position_x.reserve(count);
+    last_position_y.reserve(count);
+    velocity_x.reserve(count);
+    velocity_y.reserve(count);
+    acceleration_x.reserve(count);
+    acceleration_y.reserve(count);
+    radius.reserve(count);
+    can_collide_with_salmon.reserve(count);
+    handles.reserve(count);
+}
+
+EntityHandle PebbleStore::add(float pebble_life, vec2 position, vec2 velocity, vec2 acceleration, float pebble_radius) {
+    life.push_back(pebble_life);
+    position_x.push_back(position.x);
+    position_y.push_back(position.y);
+    last_position_x.push_back(position.x);
+    last_position_y.push_back(position.y);
+    velocity_x.push_back(velocity.x);
+    velocity_y.push_back(velocity.y);
+    acceleration_x.push_back(acceleration.x);
+    acceleration_y.push_back(acceleration.y);
+    radius.push_back(pebble_radius);
+    can_collide_with_salmon.push_back(0);
+    return handles.insert();
+}
+
+void PebbleStore::remove(size_t index) {
+    size_t last = size() - 1;
+    life[index] = life[last];
+    position_x[index] = position_x[last];
+    position_y[index] = position_y[last];
+    last_position_x[index] = last_position_x[last];
+    last_position_y[index] = last_position_y[last];
+    velocity_x[index] = velocity_x[last];
+    velocity_y[index] = velocity_y[last];
+    acceleration_x[index] = acceleration_x[last];
+    acceleration_y[index] = acceleration_y[last];
+    radius[index] = radius[last];
+    can_collide_with_salmon[index] = can_collide_with_salmon[last];
+    handles.remove(index);
+
+    life.pop_back();
+    position_x.pop_back();
+    position_y.pop_back();
+    last_position_x.pop_back();
+    last_position_y.pop_back();
+    velocity_x.pop_back();
+    velocity_y.pop_back();
+    acceleration_x.pop_back();
+    acceleration_y.pop_back();
+    radius.pop_back();
+    can_collide_with_salmon.pop_back();
+}
+
+vec2 PebbleStore::get_position(size_t index) const {
+    return {position_x[index], position_y[index]};
+}
+
+void PebbleStore::set_position(size_t index, vec2 position) {
+    position_x[index] = position.x;
+    position_y[index] = position.y;
+}
+
+vec2 PebbleStore::get_velocity(size_t index) const {
+    return {velocity_x[index], velocity_y[index]};
+}
+
+void PebbleStore::set_velocity(size_t index, vec2 velocity) {
+    velocity_x[index] = velocity.x;
+    velocity_y[index] = velocity.y;
+}
+
+void PebbleStore::integrate(float ms, float pebble_acceleration_x) {
+    size_t count = size();
+    float seconds = ms / 1000;
+    float frames = ms / GRAVITY_FRAME_MS;
+    size_t i = 0;
+
+#ifdef PEBBLES_USE_SSE
+    // Four pebbles at a time, the remainder goes through the scalar loop below
+    __m128 ms4 = _mm_set1_ps(ms);
+    __m128 seconds4 = _mm_set1_ps(seconds);
+    __m128 frames4 = _mm_set1_ps(frames);
+    __m128 acceleration_x4 = _mm_set1_ps(pebble_acceleration_x);
+
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(&life[i], _mm_sub_ps(_mm_loadu_ps(&life[i]), ms4));
+        _mm_storeu_ps(&acceleration_x[i], acceleration_x4);
+
+        __m128 vx = _mm_add_ps(_mm_loadu_ps(&velocity_x[i]), acceleration_x4);
+        __m128 vy = _mm_add_ps(_mm_loadu_ps(&velocity_y[i]), _mm_mul_ps(_mm_loadu_ps(&acceleration_y[i]), frames4));
+        _mm_storeu_ps(&velocity_x[i], vx);
+        _mm_storeu_ps(&velocity_y[i], vy);
+
+        __m128 x = _mm_loadu_ps(&position_x[i]);
+        __m128 y = _mm_loadu_ps(&position_y[i]);
+        _mm_storeu_ps(&last_position_x[i], x);
+        _mm_storeu_ps(&last_position_y[i], y);
+        _mm_storeu_ps(&position_x[i], _mm_add_ps(x, _mm_mul_ps(vx, seconds4)));
+        _mm_storeu_ps(&position_y[i], _mm_add_ps(y, _mm_mul_ps(vy, seconds4)));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        life[i] -= ms;
+        acceleration_x[i] = pebble_acceleration_x;
+
+        velocity_x[i] += acceleration_x[i];
+        velocity_y[i] += acceleration_y[i] * frames;
+
+        last_position_x[i] = position_x[i];
+        last_position_y[i] = position_y[i];
+        position_x[i] += velocity_x[i] * seconds;
+        position_y[i] += velocity_y[i] * seconds;
+    }
+}
+
+void PebbleStore::write_instances(float* instances, float alpha) const {
+    for (size_t i = 0; i < size(); ++i) {
+        instances[3 * i] = last_position_x[i] + (position_x[i] - last_position_x[i]) * alpha;
+        instances[3 * i + 1] = last_position_y[i] + (position_y[i] - last_position_y[i]) * alpha;
+        instances[3 * i + 2] = radius[i];
+    }
+}
+
+void PebbleCollider::collide(PebbleStore& pebbles) {
+    sort(pebbles);
+
+    // Sweep from left to right, a pebble can only touch the following ones until one starts
+    // past its right side
+    m_pairs.clear();
+    for (size_t i = 0; i < m_order.size(); ++i) {
+        int pebble = m_order[i];
+        float max_x = pebbles.position_x[pebble] + pebbles.radius[pebble];
+
+        for (size_t j = i + 1; j < m_order.size() && m_min_x[m_order[j]] <= max_x; ++j) {
+            int other = m_order[j];
+            float radii = pebbles.radius[pebble] + pebbles.radius[other];
+            if (std::abs(pebbles.position_y[pebble] - pebbles.position_y[other]) <= radii)
+                m_pairs.push_back({pebble, other});
+        }
+    }
+
+    for (auto& pair : m_pairs) {
+        int first = pair.first;
+        int second = pair.second;
+
+        vec2 delta_pos = sub(pebbles.get_position(first), pebbles.get_position(second));
+        float distance = len(delta_pos);
+        float radii = pebbles.radius[first] + pebbles.radius[second];
+
+        // Pebbles sitting exactly on top of each other have no normal to bounce along
+        if (distance > radii || distance <= 0.f)
+            continue;
+
+        // Elastic collision between pebbles of the same mass
+        vec2 delta_vel = sub(pebbles.get_velocity(first), pebbles.get_velocity(second));
+        vec2 exchange = mul(delta_pos, dot(delta_vel, delta_pos) / sq_len(delta_pos));
+        pebbles.set_velocity(first, sub(pebbles.get_velocity(first), exchange));
+        pebbles.set_velocity(second, add(pebbles.get_velocity(second), exchange));
+
+        // Each pebble is pushed away by half the overlap
+        float overlap = radii - distance;
+        if (overlap > 0) {
+            vec2 push = mul(normalize(delta_pos), overlap * 0.5f);
+            pebbles.set_position(first, add(pebbles.get_position(first), push));
+            pebbles.set_position(second, sub(pebbles.get_position(second), push));
+        }
+    }
+}
+
+void PebbleCollider::sort(const PebbleStore& pebbles) {
+    int count = (int) pebbles.size();
+    int previous_count = (int) m_order.size();
+
+    // Removing a pebble moves the last one into its slot, so the order of the previous frame
+    // still holds every index below the current count. Only the indices past the end are
+    // dropped and the new pebbles are appended, the sort fixes up the moved ones.
+    m_order.erase(std::remove_if(m_order.begin(), m_order.end(), [count](int index) { return index >= count; }),
+                  m_order.end());
+    for (int index = previous_count; index < count; ++index)
+        m_order.push_back(index);
+
+    m_min_x.resize(pebbles.size());
+    for (size_t i = 0; i < pebbles.size(); ++i)
+        m_min_x[i] = pebbles.position_x[i] - pebbles.radius[i];
+
+    // Insertion sort is quadratic on a shuffled array, most pebbles being new means no order to keep
+    if (count > 2 * previous_count) {
+        std::sort(m_order.begin(), m_order.end(), [this](int l, int r) { return m_min_x[l] < m_min_x[r]; });
+        return;
+    }
+
+    for (size_t i = 1; i < m_order.size(); ++i) {
+        int index = m_order[i];
+        float key = m_min_x[index];
+
+        size_t j = i;
+        while (j > 0 && m_min_x[m_order[j - 1]] > key) {
+            m_order[j] = m_order[j - 1];
+            --j;
+        }
+        m_order[j] = index;
+    }
+}
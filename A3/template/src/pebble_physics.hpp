@@ -0,0 +1,71 @@
+#pragma once
+
+#include "common.hpp"
+#include "slot_map.hpp"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Pebbles stored as one array per field, so that the update only streams through the fields
+// it needs and can process several pebbles per instruction.
+// Removing a pebble moves the last one into its slot, pebbles have no particular order, the
+// handles follow them.
+struct PebbleStore {
+    std::vector<float> life; // remove pebble when its life reaches 0
+    std::vector<float> position_x;
+    std::vector<float> position_y;
+    std::vector<float> last_position_x; // before the last integrate, drawing interpolates from it
+    std::vector<float> last_position_y;
+    std::vector<float> velocity_x;
+    std::vector<float> velocity_y;
+    std::vector<float> acceleration_x;
+    std::vector<float> acceleration_y;
+    std::vector<float> radius;
+    std::vector<uint8_t> can_collide_with_salmon;
+    SlotMap handles;
+
+    size_t size() const;
+    bool empty() const;
+    void clear();
+
+    // Room for count pebbles without reallocating
+    void reserve(size_t count);
+
+    EntityHandle add(float pebble_life, vec2 position, vec2 velocity, vec2 acceleration, float pebble_radius);
+    void remove(size_t index);
+
+    vec2 get_position(size_t index) const;
+    void set_position(size_t index, vec2 position);
+    vec2 get_velocity(size_t index) const;
+    void set_velocity(size_t index, vec2 velocity);
+
+    // Ages the pebbles by ms, sets their acceleration on x and moves them, all in one pass.
+    // acceleration_y is the velocity change over a 60 Hz frame.
+    void integrate(float ms, float pebble_acceleration_x);
+
+    // Packs x, y, radius of every pebble for the instance buffer, 3 floats per pebble, alpha of
+    // the way from the last position to the current one
+    void write_instances(float* instances, float alpha) const;
+};
+
+// Pebble - pebble collisions
+//
+// Sweep and prune: the pebbles are kept sorted by the left side of their bounding box and
+// only pebbles whose x intervals overlap are tested against each other. Pebbles barely move
+// from one frame to the next, so the order of the previous frame is kept and fixed up with
+// an insertion sort, which is close to linear on an almost sorted array.
+class PebbleCollider
+{
+public:
+    // Bounces every pair of touching pebbles off each other, once per pair
+    void collide(PebbleStore& pebbles);
+
+private:
+    // Updates m_order to the current pebbles, sorted by m_min_x
+    void sort(const PebbleStore& pebbles);
+
+    std::vector<int> m_order;
+    std::vector<float> m_min_x;
+    std::vector<std::pair<int, int>> m_pairs;
+};
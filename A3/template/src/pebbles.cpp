@@ -13,10 +13,16 @@
 // DON'T WORRY ABOUT THIS CLASS UNTIL ASSIGNMENT 3
 // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 
-static const int MAX_PEBBLES = 25;
+static const int MAX_PEBBLES = 10000;
 constexpr int NUM_SEGMENTS = 12;
 
-bool Pebbles::init(vec2 level_bounds, float current_speed) {
+// x, y and radius of a pebble, as read by pebble.vs.glsl
+constexpr size_t INSTANCE_SIZE = 3 * sizeof(float);
+
+// Frames of instances the buffer holds before it is orphaned
+constexpr size_t INSTANCE_FRAMES = 3;
+
+bool Pebbles::init(vec2 level_bounds, float current_speed, Random& random) {
 	std::vector<GLfloat> screen_vertex_buffer_data;
 	constexpr float z = -0.1;
 
@@ -42,19 +48,22 @@ bool Pebbles::init(vec2 level_bounds, float current_speed) {
 	glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
 	glBufferData(GL_ARRAY_BUFFER, screen_vertex_buffer_data.size()*sizeof(GLfloat), screen_vertex_buffer_data.data(), GL_STATIC_DRAW);
 
-	glGenBuffers(1, &m_instance_vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, m_instance_vbo);
-
 	if (gl_has_errors())
 		return false;
 
+	if (!m_instance_buffer.init(MAX_PEBBLES * INSTANCE_SIZE, INSTANCE_FRAMES))
+		return false;
+
+	// Pebbles are spawned and removed every frame, all the storage is made up front
+	m_pebbles.reserve(MAX_PEBBLES + 1);
+
 	// Loading shaders
 	if (!effect.load_from_file(shader_path("pebble.vs.glsl"), shader_path("pebble.fs.glsl")))
 		return false;
 
 	m_min_radius = 7;
 	m_max_radius = 10;
-    srand (time(NULL));
+    m_random = &random;
 
     m_x_level_bounds = {0, level_bounds.x};
     m_y_level_bounds = {0, level_bounds.y};
@@ -68,11 +77,9 @@ bool Pebbles::init(vec2 level_bounds, float current_speed) {
 // Releases all graphics resources
 void Pebbles::destroy() {
 	glDeleteBuffers(1, &mesh.vbo);
-	glDeleteBuffers(1, &m_instance_vbo);
+	m_instance_buffer.destroy();
 
-	glDeleteShader(effect.vertex);
-	glDeleteShader(effect.fragment);
-	glDeleteShader(effect.program);
+	effect.release();
 
 	m_pebbles.clear();
 }
@@ -86,53 +93,41 @@ void Pebbles::update(float ms, Salmon& salmon) {
 	if (m_pebbles.empty())
 	    return;
 
-	// Delete old pebbles
-    for (std::vector<Pebble>::iterator it = m_pebbles.begin(); it != m_pebbles.end(); it++) {
-        it->life -= ms;
-    }
-    int index = 0;
-    while (index != m_pebbles.size() && !m_pebbles.empty()) {
-        Pebble pebble = *(m_pebbles.begin() + index);
-        if (pebble.life < 0 ||
-            pebble.position.x + pebble.radius < m_x_level_bounds.x ||
-            pebble.position.x - pebble.radius > m_x_level_bounds.y ||
-            pebble.position.y + pebble.radius < m_y_level_bounds.x ||
-            pebble.position.y - pebble.radius > m_y_level_bounds.y) {
-                m_pebbles.erase(m_pebbles.begin() + index);
+    // Move pebbles, aging them on the way
+    m_pebbles.integrate(ms, m_mode3 ? -1.f * m_current_speed * ms : 0.f);
+
+	// Delete old pebbles, the last pebble takes the place of the removed one
+    size_t index = 0;
+    while (index < m_pebbles.size()) {
+        float radius = m_pebbles.radius[index];
+        if (m_pebbles.life[index] < 0 ||
+            m_pebbles.position_x[index] + radius < m_x_level_bounds.x ||
+            m_pebbles.position_x[index] - radius > m_x_level_bounds.y ||
+            m_pebbles.position_y[index] + radius < m_y_level_bounds.x ||
+            m_pebbles.position_y[index] - radius > m_y_level_bounds.y) {
+                m_pebbles.remove(index);
         } else {
             index++;
         }
     }
 
-    // Move pebbles
-	for (auto &it : m_pebbles) {
-	    if (m_mode3)
-	        it.acceleration.x = -1.f * m_current_speed * ms;
-        else
-            it.acceleration.x = 0;
-
-	    it.velocity.x += it.acceleration.x;
-	    it.velocity.y += it.acceleration.y;
-
-	    it.position.x += it.velocity.x * (ms / 1000);
-	    it.position.y += it.velocity.y * (ms / 1000);
-	}
-
-    for (auto &it : m_pebbles) {
-        if (!it.can_collide_with_salmon) {
-            if (len(sub(it.position, salmon.get_mouth_pos())) > 2 * it.radius) {
+    for (size_t i = 0; i < m_pebbles.size(); ++i) {
+        if (!m_pebbles.can_collide_with_salmon[i]) {
+            vec2 position = m_pebbles.get_position(i);
+            float radius = m_pebbles.radius[i];
+            if (len(sub(position, salmon.get_mouth_pos())) > 2 * radius) {
                 salmon.calculate_corners();
                 vec2 top_left = salmon.get_top_left_corner();
                 vec2 top_right = salmon.get_top_right_corner();
                 vec2 bottom_left = salmon.get_bottom_left_corner();
                 vec2 bottom_right = salmon.get_bottom_right_corner();
 
-                vec2 delta_pos = sub(salmon.get_position(), it.position);
-                vec2 closest = add(it.position, mul(normalize(delta_pos), it.radius));
+                vec2 delta_pos = sub(salmon.get_position(), position);
+                vec2 closest = add(position, mul(normalize(delta_pos), radius));
 
                 if (!is_inside(closest, top_left, top_right, bottom_left) &&
                     !is_inside(closest, bottom_right, top_right, bottom_left))
-                    it.can_collide_with_salmon = true;
+                    m_pebbles.can_collide_with_salmon[i] = 1;
             }
         }
     }
@@ -142,141 +137,130 @@ void Pebbles::spawn_pebble(vec2 position, float salmon_rotation, float gravity)
 	if (m_pebbles.size() > MAX_PEBBLES)
 	    return;
 
-	Pebble pebble;
-	pebble.life = 30000;
-	pebble.position = position;
-	pebble.radius = rand() % m_max_radius + m_min_radius;
+	float radius = m_random->integer(m_max_radius) + m_min_radius;
 
-	float angle = salmon_rotation + (rand() % 30 - 15) * (PI / 180);
+	float angle = salmon_rotation + (m_random->integer(30) - 15) * (PI / 180);
 	vec2 base_speed = {250, 0};
 
     float x = cos(angle) * base_speed.x - sin(angle) * base_speed.y;
     float y = sin(angle) * base_speed.x + cos(angle) * base_speed.y;
 
-    pebble.velocity = {x, y};
-    pebble.acceleration = {0, gravity};
-    pebble.can_collide_with_salmon = false;
-    m_pebbles.push_back(pebble);
+    m_pebbles.add(30000, position, {x, y}, {0, gravity}, radius);
 }
 
 void Pebbles::collides_with_pebble() {
-    for (auto &outer : m_pebbles) {
-        for (auto &inner : m_pebbles) {
-            if (outer != inner) {
-                float distance = len(sub(outer.position, inner.position));
-
-                if (distance <= outer.radius + inner.radius) {
-                    vec2 outer_vel = pebble_pebble_bounce(outer, inner);
-                    vec2 inner_vel = pebble_pebble_bounce(inner, outer);
-
-                    outer.velocity = outer_vel;
-                    inner.velocity = inner_vel;
-
-                    float overlap = (outer.radius + inner.radius) - distance;
-
-                    if (overlap > 0) {
-                        outer.position = add(outer.position, mul(normalize(sub(outer.position, inner.position)), overlap));
-                    }
-                }
-            }
-        }
-    }
+    m_collider.collide(m_pebbles);
 }
 
-void Pebbles::collides_with(Turtle& turtle) {
-    for (auto &pebble : m_pebbles) {
-        vec2 delta_pos = sub(pebble.position, turtle.get_position());
-        float d_sq = delta_pos.x * delta_pos.x + delta_pos.y * delta_pos.y;
-        float other_r = std::max(turtle.get_bounding_box().x, turtle.get_bounding_box().y);
-        float my_r = pebble.radius;
-        float r = std::max(other_r, my_r);
-        r *= 0.6f;
-        if (d_sq < r * r) {
-            vec2 normal = normalize(sub(pebble.position, turtle.get_position()));
-            pebble.velocity = sub(pebble.velocity, mul(normal, 2 * dot(normal, pebble.velocity)));
-
-            float overlap = sqrt(r * r) - sqrt(d_sq);
-            if (overlap > 0) {
-                pebble.position = add(pebble.position, mul(normalize(delta_pos), overlap));
-            }
+void Pebbles::collides_with(Salmon& salmon) {
+    for (size_t i = 0; i < m_pebbles.size(); ++i)
+        collides_with(i, salmon);
+}
 
-            if (m_mode3)
-                turtle.turn_around();
+void Pebbles::collides_with(size_t index, Turtles& turtles, size_t other) {
+    vec2 position = m_pebbles.get_position(index);
+    vec2 delta_pos = sub(position, turtles.get_position(other));
+    float d_sq = delta_pos.x * delta_pos.x + delta_pos.y * delta_pos.y;
+    float other_r = std::max(turtles.get_bounding_box().x, turtles.get_bounding_box().y);
+    float my_r = m_pebbles.radius[index];
+    float r = std::max(other_r, my_r);
+    r *= 0.6f;
+    if (d_sq < r * r) {
+        vec2 normal = normalize(sub(position, turtles.get_position(other)));
+        vec2 velocity = m_pebbles.get_velocity(index);
+        m_pebbles.set_velocity(index, sub(velocity, mul(normal, 2 * dot(normal, velocity))));
+
+        float overlap = sqrt(r * r) - sqrt(d_sq);
+        if (overlap > 0) {
+            m_pebbles.set_position(index, add(position, mul(normalize(delta_pos), overlap)));
         }
+
+        if (m_mode3)
+            turtles.turn_around(other);
     }
 }
 
-void Pebbles::collides_with(Fish& fish) {
-    for (auto &pebble : m_pebbles) {
-        vec2 delta_pos = sub(pebble.position, fish.get_position());
-        float d_sq = delta_pos.x * delta_pos.x + delta_pos.y * delta_pos.y;
-        float other_r = std::max(fish.get_bounding_box().x, fish.get_bounding_box().y);
-        float my_r = pebble.radius;
-        float r = std::max(other_r, my_r);
-        r *= 0.6f;
-
-        if (d_sq < r * r) {
-            vec2 normal = normalize(sub(pebble.position, fish.get_position()));
-            pebble.velocity = sub(pebble.velocity, mul(normal, 2 * dot(normal, pebble.velocity)));
-
-            float overlap = sqrt(r * r) - sqrt(d_sq);
-            if (overlap > 0) {
-                pebble.position = add(pebble.position, mul(normalize(delta_pos), overlap));
-            }
-
-            if (m_mode3)
-                fish.slow_down();
+void Pebbles::collides_with(size_t index, FishSchool& fish, size_t other) {
+    vec2 position = m_pebbles.get_position(index);
+    vec2 delta_pos = sub(position, fish.get_position(other));
+    float d_sq = delta_pos.x * delta_pos.x + delta_pos.y * delta_pos.y;
+    float other_r = std::max(fish.get_bounding_box().x, fish.get_bounding_box().y);
+    float my_r = m_pebbles.radius[index];
+    float r = std::max(other_r, my_r);
+    r *= 0.6f;
+
+    if (d_sq < r * r) {
+        vec2 normal = normalize(sub(position, fish.get_position(other)));
+        vec2 velocity = m_pebbles.get_velocity(index);
+        m_pebbles.set_velocity(index, sub(velocity, mul(normal, 2 * dot(normal, velocity))));
+
+        float overlap = sqrt(r * r) - sqrt(d_sq);
+        if (overlap > 0) {
+            m_pebbles.set_position(index, add(position, mul(normalize(delta_pos), overlap)));
         }
+
+        if (m_mode3)
+            fish.slow_down(other);
     }
 }
 
-void Pebbles::collides_with(Salmon& salmon) {
-
-    salmon.calculate_corners();
-    vec2 top_left = salmon.get_top_left_corner();
-    vec2 top_right = salmon.get_top_right_corner();
-    vec2 bottom_left = salmon.get_bottom_left_corner();
-    vec2 bottom_right = salmon.get_bottom_right_corner();
+void Pebbles::collides_with(size_t index, Salmon& salmon) {
+    if (m_pebbles.can_collide_with_salmon[index]) {
+        vec2 position = m_pebbles.get_position(index);
+        salmon.calculate_corners();
+        vec2 top_left = salmon.get_top_left_corner();
+        vec2 top_right = salmon.get_top_right_corner();
+        vec2 bottom_left = salmon.get_bottom_left_corner();
+        vec2 bottom_right = salmon.get_bottom_right_corner();
 
-    for (auto &pebble : m_pebbles) {
-        if (pebble.can_collide_with_salmon) {
-            vec2 delta_pos = sub(salmon.get_position(), pebble.position);
+        vec2 delta_pos = sub(salmon.get_position(), position);
 
-            vec2 closest = add(pebble.position, mul(normalize(delta_pos), pebble.radius));
+        vec2 closest = add(position, mul(normalize(delta_pos), m_pebbles.radius[index]));
 
-            if (is_inside(closest, top_left, top_right, bottom_left) ||
-                    is_inside(closest, bottom_right, top_right, bottom_left)) {
+        if (is_inside(closest, top_left, top_right, bottom_left) ||
+                is_inside(closest, bottom_right, top_right, bottom_left)) {
 
-                float top_dist = dist(closest, top_left, top_right);
-                float bottom_dist = dist(closest, bottom_left, bottom_right);
-                float left_dist = dist(closest, top_left, bottom_left);
-                float right_dist = dist(closest, top_right, bottom_right);
+            float top_dist = dist(closest, top_left, top_right);
+            float bottom_dist = dist(closest, bottom_left, bottom_right);
+            float left_dist = dist(closest, top_left, bottom_left);
+            float right_dist = dist(closest, top_right, bottom_right);
 
-                vec2 normal;
+            vec2 normal;
 
-                if (top_dist < std::min(right_dist, std::min(bottom_dist, left_dist))) {
-                    normal = normalize(sub(top_left, bottom_left));
-                    pebble.position = add(pebble.position, mul(normal, top_dist));
+            if (top_dist < std::min(right_dist, std::min(bottom_dist, left_dist))) {
+                normal = normalize(sub(top_left, bottom_left));
+                m_pebbles.set_position(index, add(position, mul(normal, top_dist)));
 
-                } else if (bottom_dist < std::min(top_dist, std::min(left_dist, right_dist))) {
-                    normal = normalize(sub(bottom_left, top_left));
-                    pebble.position = add(pebble.position, mul(normal, bottom_dist));
+            } else if (bottom_dist < std::min(top_dist, std::min(left_dist, right_dist))) {
+                normal = normalize(sub(bottom_left, top_left));
+                m_pebbles.set_position(index, add(position, mul(normal, bottom_dist)));
 
-                } else if (left_dist < std::min(top_dist, std::min(bottom_dist, right_dist))) {
-                    normal = normalize(sub(top_left, top_right));
-                    pebble.position = add(pebble.position, mul(normal, left_dist));
+            } else if (left_dist < std::min(top_dist, std::min(bottom_dist, right_dist))) {
+                normal = normalize(sub(top_left, top_right));
+                m_pebbles.set_position(index, add(position, mul(normal, left_dist)));
 
-                } else {
-                    normal = normalize(sub(top_right, top_left));
-                    pebble.position = add(pebble.position, mul(normal, right_dist));
-                }
-
-                pebble.velocity = sub(pebble.velocity, mul(normal, 2 * dot(normal, pebble.velocity)));
+            } else {
+                normal = normalize(sub(top_right, top_left));
+                m_pebbles.set_position(index, add(position, mul(normal, right_dist)));
             }
+
+            vec2 velocity = m_pebbles.get_velocity(index);
+            m_pebbles.set_velocity(index, sub(velocity, mul(normal, 2 * dot(normal, velocity))));
         }
     }
 }
 
+size_t Pebbles::get_pebble_count() const {
+    return m_pebbles.size();
+}
+
+void Pebbles::get_pebble_bounds(size_t index, vec2& min, vec2& max) const {
+    vec2 position = m_pebbles.get_position(index);
+    float radius = m_pebbles.radius[index];
+    min = {position.x - radius, position.y - radius};
+    max = {position.x + radius, position.y + radius};
+}
+
 float Pebbles::sign (vec2 p1, vec2 p2, vec2 p3) {
     return (p1.x - p3.x) * (p2.y - p3.y) - (p2.x - p3.x) * (p1.y - p3.y);
 }
@@ -300,13 +284,6 @@ float Pebbles::dist (vec2 pt, vec2 p1, vec2 p2) {
     return num/den;
 }
 
-vec2 Pebbles::pebble_pebble_bounce(Pebble &pebble1, Pebble& pebble2) {
-    float mass_comp = 1;
-    vec2 delta_pos = sub(pebble1.position, pebble2.position);
-    float delta_vel = dot(sub(pebble1.velocity, pebble2.velocity), delta_pos) / sq_len(delta_pos);
-    return sub(pebble1.velocity, mul(delta_pos, mass_comp * delta_vel));
-}
-
 // Draw pebbles using instancing
 void Pebbles::draw(const mat3& projection) {
 	// Setting shaders
@@ -335,20 +312,23 @@ void Pebbles::draw(const mat3& projection) {
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
 	glVertexAttribDivisor(0, 0);
 
-	// Load up pebbles into buffer
-	glBindBuffer(GL_ARRAY_BUFFER, m_instance_vbo);
-	glBufferData(GL_ARRAY_BUFFER, m_pebbles.size() * sizeof(Pebble), m_pebbles.data(), GL_DYNAMIC_DRAW);
+	// Load up pebbles into buffer, written straight into the mapped range
+	void* instances = m_instance_buffer.map(m_pebbles.size() * INSTANCE_SIZE);
+	if (instances == nullptr) // no pebbles, or the map failed
+		return;
+	m_pebbles.write_instances((float*)instances, draw_alpha);
+	size_t instance_offset = m_instance_buffer.unmap();
 
 	// Pebble translations
 	// Bind to attribute 1 (in_translate) as in vertex shader
 	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Pebble), (GLvoid*)offsetof(Pebble, position));
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, INSTANCE_SIZE, (GLvoid*)instance_offset);
 	glVertexAttribDivisor(1, 1);
 
 	// Pebble radii
 	// Bind to attribute 2 (in_scale) as in vertex shader
 	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(Pebble), (GLvoid*)offsetof(Pebble, radius));
+	glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, INSTANCE_SIZE, (GLvoid*)(instance_offset + 2 * sizeof(float)));
 	glVertexAttribDivisor(2, 1);
 
 	// Draw using instancing
@@ -3,6 +3,10 @@
 #include <vector>
 
 #include "common.hpp"
+#include "pebble_physics.hpp"
+#include "random.hpp"
+#include "stream_buffer.hpp"
+#include "salmon.hpp"
 #include "turtle.hpp"
 #include "fish.hpp"
 
@@ -14,40 +18,8 @@
 class Pebbles : public Entity
 {
 public:
-	// Data structure for pebble contains information needed
-	// to render and simulate a basic pebble (apart from mesh.vbo), 
-	// we will use this layout to pass information from m_pebbles to the pipeline.
-	struct Pebble {
-		float life = 0.0f; // remove pebble when its life reaches 0
-		vec2 position;
-		vec2 velocity;
-		vec2 acceleration;
-		float radius;
-		bool can_collide_with_salmon;
-        bool operator==(const Pebble& other) const {
-            return life == other.life &&
-                    position.x == other.position.x &&
-                    position.y == other.position.y &&
-                    velocity.x == other.velocity.x &&
-                    velocity.y == other.velocity.y &&
-                    acceleration.x == other.acceleration.x &&
-                    acceleration.y == other.acceleration.y &&
-                    radius == other.radius;
-        }
-        bool operator!=(const Pebble& other) const {
-            return life != other.life ||
-                   position.x != other.position.x ||
-                   position.y != other.position.y ||
-                   velocity.x != other.velocity.x ||
-                   velocity.y != other.velocity.y ||
-                   acceleration.x != other.acceleration.x ||
-                   acceleration.y != other.acceleration.y ||
-                   radius != other.radius;
-        }
-	};
-
-	// Creates all the associated render resources
-	bool init(vec2 level_bounds, float current_speed);
+	// Creates all the associated render resources, pebble sizes and angles are drawn from random
+	bool init(vec2 level_bounds, float current_speed, Random& random);
 
 	// Releases all associated resources
 	void destroy();
@@ -65,10 +37,20 @@ public:
 
 	// Trigger collision checks
 	void collides_with_pebble();
-    void collides_with(Turtle& turtle);
-    void collides_with(Fish& fish);
     void collides_with(Salmon& salmon);
 
+    // Same as above for a single pebble, for pairs found by the broadphase
+    void collides_with(size_t index, Salmon& salmon);
+
+    // Pebble index against turtle or fish other, for pairs found by the broadphase
+    void collides_with(size_t index, Turtles& turtles, size_t other);
+    void collides_with(size_t index, FishSchool& fish, size_t other);
+
+    size_t get_pebble_count() const;
+
+    // Bounding box of a pebble
+    void get_pebble_bounds(size_t index, vec2& min, vec2& max) const;
+
     float sign (vec2 p1, vec2 p2, vec2 p3);
     bool is_inside (vec2 pt, vec2 v1, vec2 v2, vec2 v3);
     float dist (vec2 pt, vec2 p1, vec2 p2);
@@ -79,8 +61,6 @@ public:
 
 private:
 
-    vec2 pebble_pebble_bounce(Pebble &pebble1, Pebble& pebble2);
-
     int m_min_radius;
     int m_max_radius;
 
@@ -91,6 +71,9 @@ private:
 
     bool m_mode3;
 
-	GLuint m_instance_vbo; // vbo for instancing pebbles
-	std::vector<Pebble> m_pebbles; // vector of pebbles
+    Random* m_random;
+
+	StreamBuffer m_instance_buffer; // vbo for instancing pebbles
+	PebbleStore m_pebbles;
+	PebbleCollider m_collider;
 };
\ No newline at end of file
@@ -0,0 +1,61 @@
+// Header
+#include "platform.hpp"
+
+#include "null_gl.hpp"
+
+bool NullWindow::init(vec2 screen) {
+    m_screen = screen;
+    null_gl_init();
+    return true;
+}
+
+void NullWindow::destroy() {
+}
+
+void NullWindow::set_callbacks(KeyCallback, CursorCallback, MouseButtonCallback) {
+}
+
+void NullWindow::poll_events() {
+}
+
+void NullWindow::get_framebuffer_size(int& width, int& height) const {
+    width = (int) m_screen.x;
+    height = (int) m_screen.y;
+}
+
+vec2 NullWindow::get_cursor_position() const {
+    return {0.f, 0.f};
+}
+
+void NullWindow::set_title(const char*) {
+}
+
+void NullWindow::swap_buffers() {
+}
+
+bool NullWindow::should_close() const {
+    return false;
+}
+
+bool NullAudio::init() {
+    return true;
+}
+
+void NullAudio::destroy() {
+}
+
+void NullAudio::load(AssetLoader&) {
+}
+
+void NullAudio::set_theme(Theme) {
+}
+
+void NullAudio::play_salmon_dead() {
+}
+
+void NullAudio::play_salmon_eat() {
+}
+
+size_t NullAudio::get_resident_bytes() const {
+    return 0;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "common.hpp"
+#include "asset_loader.hpp"
+
+#include <functional>
+
+// What the game needs from the window and the GL context it owns. The game itself never calls
+// GLFW, so that it can run without a window behind NullWindow.
+class Window
+{
+public:
+    // GLFW_KEY_*, GLFW_PRESS / GLFW_RELEASE / GLFW_REPEAT and GLFW_MOD_* values
+    typedef std::function<void(int key, int action, int mod)> KeyCallback;
+    typedef std::function<void(double x, double y)> CursorCallback;
+    typedef std::function<void(int button, int action, int mod)> MouseButtonCallback;
+
+    virtual ~Window() {}
+
+    // Opens a screen sized window and makes its GL context current
+    virtual bool init(vec2 screen) = 0;
+
+    virtual void destroy() = 0;
+
+    virtual void set_callbacks(KeyCallback on_key, CursorCallback on_mouse_move,
+                               MouseButtonCallback on_mouse_click) = 0;
+
+    // Runs the callbacks of the input received since the last call
+    virtual void poll_events() = 0;
+
+    // In pixels, larger than the window size on high DPI displays
+    virtual void get_framebuffer_size(int& width, int& height) const = 0;
+
+    // Relative to the top-left of the window
+    virtual vec2 get_cursor_position() const = 0;
+
+    virtual void set_title(const char* title) = 0;
+
+    virtual void swap_buffers() = 0;
+
+    virtual bool should_close() const = 0;
+};
+
+// Sound effects and music
+class Audio
+{
+public:
+    // Sets of sounds, the default one and the one of mode 3
+    enum Theme { DEFAULT_THEME, DOPE_THEME, THEME_COUNT };
+
+    virtual ~Audio() {}
+
+    // Opens the device
+    virtual bool init() = 0;
+
+    virtual void destroy() = 0;
+
+    // Starts decoding the sounds of every theme on the loader. A sound is silent until it is
+    // decoded, nothing is read from disk afterwards.
+    virtual void load(AssetLoader& loader) = 0;
+
+    // Switches to the sounds of theme and restarts its music
+    virtual void set_theme(Theme theme) = 0;
+
+    virtual void play_salmon_dead() = 0;
+    virtual void play_salmon_eat() = 0;
+
+    // Decoded audio kept in memory
+    virtual size_t get_resident_bytes() const = 0;
+};
+
+// No window at all, GL calls go to the null implementation. Never closes, the caller decides
+// when to stop.
+class NullWindow : public Window
+{
+public:
+    bool init(vec2 screen) override;
+    void destroy() override;
+    void set_callbacks(KeyCallback on_key, CursorCallback on_mouse_move,
+                       MouseButtonCallback on_mouse_click) override;
+    void poll_events() override;
+    void get_framebuffer_size(int& width, int& height) const override;
+    vec2 get_cursor_position() const override;
+    void set_title(const char* title) override;
+    void swap_buffers() override;
+    bool should_close() const override;
+
+private:
+    vec2 m_screen;
+};
+
+// Plays nothing
+class NullAudio : public Audio
+{
+public:
+    bool init() override;
+    void destroy() override;
+    void load(AssetLoader& loader) override;
+    void set_theme(Theme theme) override;
+    void play_salmon_dead() override;
+    void play_salmon_eat() override;
+    size_t get_resident_bytes() const override;
+};
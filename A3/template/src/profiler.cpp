@@ -0,0 +1,181 @@
+// Header
+#include "profiler.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    // Zones kept per thread, the oldest ones are overwritten first
+    const size_t ZONE_CAPACITY = 1 << 15;
+
+    struct Zone {
+        const char* name;
+        uint64_t start_ns;
+        uint64_t end_ns;
+    };
+
+    // Ring buffer of one thread. The lock is only ever contended while a trace is saved.
+    struct ThreadZones {
+        std::mutex mutex;
+        std::vector<Zone> zones;
+        size_t count = 0; // zones written since the start, the next one goes to count % ZONE_CAPACITY
+        int id = 0;
+        const char* name = nullptr;
+        bool in_use = false;
+    };
+
+    // Buffers outlive their thread and are handed to the next thread that starts, so the planner
+    // thread restarted on every reset keeps a single lane
+    std::mutex g_threads_mutex;
+    std::vector<std::unique_ptr<ThreadZones>> g_threads;
+
+    ThreadZones* acquire_thread_zones() {
+        std::lock_guard<std::mutex> lock(g_threads_mutex);
+        for (auto& thread : g_threads) {
+            if (!thread->in_use) {
+                thread->in_use = true;
+                return thread.get();
+            }
+        }
+
+        std::unique_ptr<ThreadZones> thread(new ThreadZones());
+        thread->zones.resize(ZONE_CAPACITY);
+        thread->id = (int) g_threads.size() + 1;
+        thread->in_use = true;
+        g_threads.push_back(std::move(thread));
+        return g_threads.back().get();
+    }
+
+    struct ThreadSlot {
+        ThreadZones* zones = nullptr;
+
+        ~ThreadSlot() {
+            if (zones == nullptr)
+                return;
+            std::lock_guard<std::mutex> lock(g_threads_mutex);
+            zones->in_use = false;
+        }
+    };
+
+    thread_local ThreadSlot t_slot;
+
+    ThreadZones& this_thread_zones() {
+        if (t_slot.zones == nullptr)
+            t_slot.zones = acquire_thread_zones();
+        return *t_slot.zones;
+    }
+}
+
+ProfileZone::ProfileZone(const char* name) : m_name(name), m_start_ns(Profiler::now_ns()), m_ended(false) {
+}
+
+ProfileZone::~ProfileZone() {
+    end();
+}
+
+void ProfileZone::end() {
+    if (m_ended)
+        return;
+    m_ended = true;
+
+    Zone zone = { m_name, m_start_ns, Profiler::now_ns() };
+    ThreadZones& thread = this_thread_zones();
+    std::lock_guard<std::mutex> lock(thread.mutex);
+    thread.zones[thread.count % ZONE_CAPACITY] = zone;
+    ++thread.count;
+}
+
+uint64_t Profiler::now_ns() {
+    using namespace std::chrono;
+    return (uint64_t) duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::set_thread_name(const char* name) {
+    ThreadZones& thread = this_thread_zones();
+    std::lock_guard<std::mutex> lock(thread.mutex);
+    thread.name = name;
+}
+
+bool Profiler::save_trace(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        fprintf(stderr, "Failed to create trace %s\n", path);
+        return false;
+    }
+
+    // Copied out first so that no thread waits on the file being written
+    std::vector<Zone> zones;
+    std::vector<int> zone_threads;
+    std::vector<std::pair<int, const char*>> names;
+    {
+        std::lock_guard<std::mutex> threads_lock(g_threads_mutex);
+        for (auto& thread : g_threads) {
+            std::lock_guard<std::mutex> lock(thread->mutex);
+            names.emplace_back(thread->id, thread->name);
+
+            size_t kept = thread->count < ZONE_CAPACITY ? thread->count : ZONE_CAPACITY;
+            for (size_t i = thread->count - kept; i < thread->count; ++i) {
+                zones.push_back(thread->zones[i % ZONE_CAPACITY]);
+                zone_threads.push_back(thread->id);
+            }
+        }
+    }
+
+    uint64_t origin_ns = UINT64_MAX;
+    for (auto& zone : zones)
+        origin_ns = zone.start_ns < origin_ns ? zone.start_ns : origin_ns;
+
+    // Times are in microseconds, names are written as they are and must not need escaping
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (auto& name : names) {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"",
+                first ? "" : ",\n", name.first);
+        if (name.second != nullptr)
+            fprintf(file, "%s\"}}", name.second);
+        else
+            fprintf(file, "thread %d\"}}", name.first);
+        first = false;
+    }
+    for (size_t i = 0; i < zones.size(); ++i) {
+        fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",\n", zones[i].name, zone_threads[i],
+                (zones[i].start_ns - origin_ns) / 1000.0, (zones[i].end_ns - zones[i].start_ns) / 1000.0);
+        first = false;
+    }
+    fprintf(file, "\n]}\n");
+
+    bool written = ferror(file) == 0;
+    fclose(file);
+    if (!written) {
+        fprintf(stderr, "Failed to write trace %s\n", path);
+        return false;
+    }
+
+    fprintf(stderr, "Saved %zu zones to %s\n", zones.size(), path);
+    return true;
+}
+
+StartupTimer::StartupTimer() : m_start_ns(Profiler::now_ns()), m_last_ns(m_start_ns) {
+}
+
+void StartupTimer::mark(const char* phase) {
+    uint64_t now = Profiler::now_ns();
+    m_phases.push_back({phase, now - m_last_ns});
+    m_last_ns = now;
+}
+
+void StartupTimer::report() const {
+    fprintf(stderr, "Started in %.1f ms:", (m_last_ns - m_start_ns) / 1e6);
+    for (size_t i = 0; i < m_phases.size(); ++i)
+        fprintf(stderr, "%s %s %.1f ms", i == 0 ? "" : ",", m_phases[i].name, m_phases[i].ns / 1e6);
+    fprintf(stderr, "\n");
+}
+
+double StartupTimer::get_elapsed_ms() const {
+    return (Profiler::now_ns() - m_start_ns) / 1e6;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Scoped CPU zones, exported as Chrome trace events
+//
+//   bool World::update(float ms) {
+//       PROFILE_ZONE("update");
+//       ...
+//
+// A zone reads a nanosecond clock when it starts and when it ends, then stores itself in a ring
+// buffer owned by the calling thread. Each thread keeps its last ZONE_CAPACITY zones, and
+// save_trace() writes those of every thread in a file that chrome://tracing and
+// https://ui.perfetto.dev can open. Zones nest, the viewers stack them by their times.
+class ProfileZone
+{
+public:
+    // name is kept as a pointer, it must live as long as the program, e.g. a string literal
+    explicit ProfileZone(const char* name);
+
+    ~ProfileZone();
+
+    // Ends the zone before it goes out of scope, for phases that do not have a block of their own
+    void end();
+
+private:
+    const char* m_name;
+    uint64_t m_start_ns;
+    bool m_ended;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+// Zone lasting until the end of the enclosing scope
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+
+class Profiler
+{
+public:
+    // Nanoseconds on a monotonic clock
+    static uint64_t now_ns();
+
+    // Names the lane of the calling thread in the trace, name must live as long as the program
+    static void set_thread_name(const char* name);
+
+    // Writes the zones recorded so far by every thread to path in the trace event format
+    static bool save_trace(const char* path);
+};
+
+// Wall time of the phases of startup, printed as one line
+//
+//   StartupTimer startup;
+//   load_shaders();
+//   startup.mark("shaders");
+//   ...
+//   startup.report();
+class StartupTimer
+{
+public:
+    // Starts timing the first phase
+    StartupTimer();
+
+    // Ends the current phase, phase must live as long as the program, e.g. a string literal
+    void mark(const char* phase);
+
+    // Prints the phases marked so far and their total
+    void report() const;
+
+    // Since the timer was created
+    double get_elapsed_ms() const;
+
+private:
+    struct Phase {
+        const char* name;
+        uint64_t ns;
+    };
+
+    uint64_t m_start_ns;
+    uint64_t m_last_ns;
+    std::vector<Phase> m_phases;
+};
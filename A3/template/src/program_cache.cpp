@@ -0,0 +1,174 @@
+// Header
+#include "program_cache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+    const char* CACHE_DIRECTORY = PROJECT_SOURCE_DIR "./shader_cache";
+    const uint32_t CACHE_FILE_MAGIC = 0x47525053; // "SPRG"
+
+    struct CacheFileHeader {
+        uint32_t magic;
+        uint32_t format; // binaryFormat of glGetProgramBinary
+        uint32_t length;
+        uint32_t padding;
+        uint64_t key;
+    };
+
+    // Hash of the driver strings, or 0 until the first key() and forever if binaries aren't supported
+    bool checked_driver = false;
+    uint64_t driver_hash = 0;
+
+    // FNV-1a, continuing from hash
+    uint64_t hash_bytes(uint64_t hash, const void* data, size_t size) {
+        const uint8_t* bytes = (const uint8_t*) data;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    uint64_t hash_string(uint64_t hash, const char* string) {
+        // The terminator keeps "ab" + "c" apart from "a" + "bc"
+        return string != nullptr ? hash_bytes(hash, string, strlen(string) + 1) : hash_bytes(hash, "", 1);
+    }
+
+    // Program binaries are core since GL 4.1, a 3.3 context has them only with
+    // ARB_get_program_binary. Without either, even asking for the binary formats is an
+    // INVALID_ENUM that would fail the next gl_has_errors() of the caller.
+    bool has_program_binary() {
+        GLint major = 0;
+        GLint minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        if (major > 4 || (major == 4 && minor >= 1))
+            return true;
+
+        GLint extension_count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+        for (GLint i = 0; i < extension_count; ++i) {
+            const char* extension = (const char*) glGetStringi(GL_EXTENSIONS, (GLuint) i);
+            if (extension != nullptr && strcmp(extension, "GL_ARB_get_program_binary") == 0)
+                return true;
+        }
+        return false;
+    }
+
+    std::string cache_path(uint64_t key) {
+        char name[32];
+        snprintf(name, sizeof(name), "/%016llx.bin", (unsigned long long) key);
+        return std::string(CACHE_DIRECTORY) + name;
+    }
+}
+
+uint64_t ProgramCache::key(const std::string& vs_source, const std::string& fs_source) {
+    if (!checked_driver) {
+        checked_driver = true;
+        GLint formats = 0;
+        if (has_program_binary())
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        if (formats > 0 && glGetProgramBinary != nullptr && glProgramBinary != nullptr) {
+            driver_hash = 14695981039346656037ull;
+            driver_hash = hash_string(driver_hash, (const char*) glGetString(GL_VENDOR));
+            driver_hash = hash_string(driver_hash, (const char*) glGetString(GL_RENDERER));
+            driver_hash = hash_string(driver_hash, (const char*) glGetString(GL_VERSION));
+        }
+    }
+    if (driver_hash == 0)
+        return 0;
+
+    uint64_t hash = hash_string(driver_hash, vs_source.c_str());
+    hash = hash_string(hash, fs_source.c_str());
+    return hash != 0 ? hash : 1;
+}
+
+GLuint ProgramCache::load(uint64_t key) {
+    if (key == 0)
+        return 0;
+
+    FILE* file = fopen(cache_path(key).c_str(), "rb");
+    if (file == nullptr)
+        return 0;
+
+    CacheFileHeader header;
+    std::vector<char> binary;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 && header.magic == CACHE_FILE_MAGIC &&
+              header.key == key;
+    if (ok) {
+        binary.resize(header.length);
+        ok = fread(binary.data(), 1, binary.size(), file) == binary.size();
+    }
+    fclose(file);
+    if (!ok)
+        return 0;
+
+    gl_flush_errors();
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, (GLenum) header.format, binary.data(), (GLsizei) binary.size());
+
+    GLint is_linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &is_linked);
+    if (is_linked == GL_FALSE || gl_has_errors()) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void ProgramCache::prepare(uint64_t key, GLuint program) {
+    if (key != 0)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ProgramCache::save(uint64_t key, GLuint program) {
+    if (key == 0)
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    CacheFileHeader header = {};
+    header.magic = CACHE_FILE_MAGIC;
+    header.key = key;
+    std::vector<char> binary((size_t) length);
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0)
+        return;
+    header.format = format;
+    header.length = (uint32_t) written;
+
+    // Fails harmlessly when the directory is already there
+#ifdef _WIN32
+    _mkdir(CACHE_DIRECTORY);
+#else
+    mkdir(CACHE_DIRECTORY, 0755);
+#endif
+
+    std::string path = cache_path(key);
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        fprintf(stderr, "Failed to create %s, shaders will be compiled again next time\n", path.c_str());
+        return;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(binary.data(), 1, (size_t) written, file) == (size_t) written;
+    ok = fclose(file) == 0 && ok;
+
+    // A partial file would only be rejected on load, but there's no point keeping it
+    if (!ok)
+        remove(path.c_str());
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "common.hpp"
+
+#include <cstdint>
+#include <string>
+
+// Linked shader programs saved to disk with glGetProgramBinary, so that later runs load them
+// instead of compiling and linking the shaders again. Used by Entity::Effect::load_from_file.
+//
+// A program is keyed by a hash of its two sources and of the GL vendor, renderer and version
+// strings, so editing a shader or updating the driver leads to a new key rather than to a stale
+// binary. A driver may still refuse a binary it wrote earlier, load() then returns 0 and the
+// caller compiles as if the cache was empty. On a context with neither GL 4.1 nor
+// ARB_get_program_binary, or without any binary format (as under null_gl), the cache is disabled
+// and every key is 0.
+class ProgramCache
+{
+public:
+    // Key of the program linked from the two sources on the current driver, 0 if disabled
+    static uint64_t key(const std::string& vs_source, const std::string& fs_source);
+
+    // New program created from the binary saved under key, 0 if there is none or it's rejected
+    static GLuint load(uint64_t key);
+
+    // Lets the driver keep the binary of program around, must come before linking it
+    static void prepare(uint64_t key, GLuint program);
+
+    // Saves the binary of the linked program under key
+    static void save(uint64_t key, GLuint program);
+};
@@ -0,0 +1,24 @@
+// Header
+#include "random.hpp"
+
+Random::Random() {
+    seed(std::random_device()());
+}
+
+void Random::seed(uint32_t seed) {
+    m_seed = seed;
+    m_engine.seed(seed);
+}
+
+uint32_t Random::get_seed() const {
+    return m_seed;
+}
+
+float Random::uniform() {
+    // The top 24 bits fill the float mantissa exactly
+    return (float) (m_engine() >> 8) * (1.f / 16777216.f);
+}
+
+int Random::integer(int n) {
+    return (int) (m_engine() % (uint32_t) n);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+// The one source of randomness of the game. Everything random is drawn from this generator, so a
+// game started from the same seed and fed the same input plays out the same.
+//
+// Numbers are made from the raw mt19937 output instead of going through the <random>
+// distributions, whose algorithms differ between standard libraries.
+class Random
+{
+public:
+    // Seeded from std::random_device
+    Random();
+
+    // Restarts the sequence from seed
+    void seed(uint32_t seed);
+
+    uint32_t get_seed() const;
+
+    // Uniform in [0, 1)
+    float uniform();
+
+    // Uniform in [0, n), n > 0
+    int integer(int n);
+
+private:
+    uint32_t m_seed;
+    std::mt19937 m_engine;
+};
@@ -0,0 +1,137 @@
+// Header
+#include "replay.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    const char* const REPLAY_MAGIC = "salmon-replay";
+    const int REPLAY_VERSION = 1;
+}
+
+bool InputRecorder::init(const char* path, uint32_t seed) {
+    m_file = fopen(path, "w");
+    if (m_file == nullptr) {
+        fprintf(stderr, "Failed to create replay %s\n", path);
+        return false;
+    }
+
+    fprintf(m_file, "%s %d\nseed %u\n", REPLAY_MAGIC, REPLAY_VERSION, seed);
+    return true;
+}
+
+void InputRecorder::destroy(uint32_t ticks) {
+    if (m_file == nullptr)
+        return;
+
+    fprintf(m_file, "end %u\n", ticks);
+    fclose(m_file);
+    m_file = nullptr;
+}
+
+bool InputRecorder::is_recording() const {
+    return m_file != nullptr;
+}
+
+void InputRecorder::record(const InputEvent& event) {
+    switch (event.type) {
+        case InputEvent::STEP:
+            fprintf(m_file, "%u step %a\n", event.tick, event.ms);
+            break;
+        case InputEvent::KEY:
+            fprintf(m_file, "%u key %d %d %d\n", event.tick, event.code, event.action, event.mod);
+            break;
+        case InputEvent::MOUSE_BUTTON:
+            fprintf(m_file, "%u mouse %d %d %d\n", event.tick, event.code, event.action, event.mod);
+            break;
+    }
+}
+
+bool InputPlayer::init(const char* path) {
+    destroy();
+
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        fprintf(stderr, "Failed to open replay %s\n", path);
+        return false;
+    }
+
+    char magic[32];
+    int version = 0;
+    if (fscanf(file, "%31s %d seed %u", magic, &version, &m_seed) != 3 ||
+        strcmp(magic, REPLAY_MAGIC) != 0 || version != REPLAY_VERSION) {
+        fprintf(stderr, "%s is not a replay of version %d\n", path, REPLAY_VERSION);
+        fclose(file);
+        return false;
+    }
+
+    // A recording cut short by a crash has no end, it then stops after its last event
+    bool has_end = false;
+    char word[32];
+    while (fscanf(file, "%31s", word) == 1) {
+        if (strcmp(word, "end") == 0) {
+            has_end = fscanf(file, "%u", &m_ticks) == 1;
+            break;
+        }
+
+        InputEvent event = {};
+        event.tick = (uint32_t) strtoul(word, nullptr, 10);
+
+        char type[32];
+        bool valid = fscanf(file, "%31s", type) == 1;
+        if (valid && strcmp(type, "step") == 0) {
+            // %a is not read back by every scanf, strtof takes hexadecimal floats everywhere
+            char ms[64];
+            valid = fscanf(file, "%63s", ms) == 1;
+            event.type = InputEvent::STEP;
+            event.ms = strtof(ms, nullptr);
+        } else if (valid && (strcmp(type, "key") == 0 || strcmp(type, "mouse") == 0)) {
+            valid = fscanf(file, "%d %d %d", &event.code, &event.action, &event.mod) == 3;
+            event.type = type[0] == 'k' ? InputEvent::KEY : InputEvent::MOUSE_BUTTON;
+        } else {
+            valid = false;
+        }
+
+        if (!valid) {
+            fprintf(stderr, "Malformed event in replay %s\n", path);
+            fclose(file);
+            m_events.clear();
+            return false;
+        }
+        m_events.push_back(event);
+    }
+    fclose(file);
+
+    if (!has_end)
+        m_ticks = m_events.empty() ? 0 : m_events.back().tick + 1;
+
+    m_playing = true;
+    return true;
+}
+
+void InputPlayer::destroy() {
+    m_events.clear();
+    m_next = 0;
+    m_playing = false;
+}
+
+bool InputPlayer::is_playing() const {
+    return m_playing;
+}
+
+uint32_t InputPlayer::get_seed() const {
+    return m_seed;
+}
+
+bool InputPlayer::next(uint32_t tick, InputEvent& event) {
+    if (m_next == m_events.size() || m_events[m_next].tick > tick)
+        return false;
+
+    event = m_events[m_next++];
+    return true;
+}
+
+bool InputPlayer::is_finished(uint32_t tick) const {
+    return m_playing && tick >= m_ticks;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Something the world was told before one of its updates
+struct InputEvent
+{
+    enum Type { KEY, MOUSE_BUTTON, STEP };
+
+    // Number of updates done when the event arrived, it is applied before the next one
+    uint32_t tick;
+    Type type;
+
+    // KEY and MOUSE_BUTTON, as passed to World::on_key and World::on_mouse_click
+    int code;
+    int action;
+    int mod;
+
+    // STEP, the milliseconds every update takes from this tick on
+    float ms;
+};
+
+// Writes the seed of a game and the input it received to a text file, one event per line:
+//
+//   salmon-replay 1
+//   seed <seed>
+//   <tick> step <ms>
+//   <tick> key <key> <action> <mod>
+//   <tick> mouse <button> <action> <mod>
+//   end <ticks>
+//
+// Steps are written in hexadecimal floating point so they read back exactly.
+class InputRecorder
+{
+public:
+    // Creates the file and writes the header
+    bool init(const char* path, uint32_t seed);
+
+    // Ends the recording after ticks updates and closes the file
+    void destroy(uint32_t ticks);
+
+    bool is_recording() const;
+
+    void record(const InputEvent& event);
+
+private:
+    FILE* m_file = nullptr;
+};
+
+// Reads a recording back and hands its events out in order
+class InputPlayer
+{
+public:
+    // Loads the whole recording
+    bool init(const char* path);
+
+    void destroy();
+
+    bool is_playing() const;
+
+    uint32_t get_seed() const;
+
+    // Pops the next event to apply before update tick, false once there are none left for it
+    bool next(uint32_t tick, InputEvent& event);
+
+    // True once the recording ran for as many updates as it was recorded for
+    bool is_finished(uint32_t tick) const;
+
+private:
+    std::vector<InputEvent> m_events;
+    size_t m_next = 0;
+    uint32_t m_seed = 0;
+    uint32_t m_ticks = 0;
+    bool m_playing = false;
+};
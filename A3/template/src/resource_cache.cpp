@@ -0,0 +1,260 @@
+// Header
+#include "resource_cache.hpp"
+
+#include <cstdint>
+#include <cstdio>
+
+void ResourceCache::destroy() {
+    for (auto& mesh : m_meshes)
+        free_mesh(*mesh);
+    m_meshes.clear();
+
+    for (auto& quad : m_quads)
+        free_quad(*quad);
+    m_quads.clear();
+
+    for (auto& effect : m_effects)
+        effect->effect.release();
+    m_effects.clear();
+
+    // ~Texture() deletes the GL texture
+    m_textures.clear();
+}
+
+void ResourceCache::purge() {
+    for (size_t i = m_meshes.size(); i-- > 0;) {
+        if (m_meshes[i]->references > 0)
+            continue;
+        free_mesh(*m_meshes[i]);
+        m_meshes.erase(m_meshes.begin() + i);
+    }
+
+    // Quads first, they hold references on the textures
+    for (size_t i = m_quads.size(); i-- > 0;) {
+        if (m_quads[i]->references > 0)
+            continue;
+        free_quad(*m_quads[i]);
+        m_quads.erase(m_quads.begin() + i);
+    }
+
+    for (size_t i = m_effects.size(); i-- > 0;) {
+        if (m_effects[i]->references > 0)
+            continue;
+        m_effects[i]->effect.release();
+        m_effects.erase(m_effects.begin() + i);
+    }
+
+    for (size_t i = m_textures.size(); i-- > 0;) {
+        if (m_textures[i]->references == 0)
+            m_textures.erase(m_textures.begin() + i);
+    }
+}
+
+const Texture* ResourceCache::acquire_texture(const char* path) {
+    TextureEntry* entry = find_texture(path);
+    if (entry == nullptr) {
+        std::unique_ptr<TextureEntry> loaded(new TextureEntry());
+        if (!loaded->texture.load_from_file(path)) {
+            fprintf(stderr, "Failed to load texture %s\n", path);
+            return nullptr;
+        }
+
+        loaded->path = path;
+        entry = loaded.get();
+        m_textures.push_back(std::move(loaded));
+    }
+
+    ++entry->references;
+    return &entry->texture;
+}
+
+void ResourceCache::release_texture(const char* path) {
+    TextureEntry* entry = find_texture(path);
+    if (entry != nullptr && entry->references > 0)
+        --entry->references;
+}
+
+const Entity::Effect* ResourceCache::acquire_effect(const char* vs_path, const char* fs_path) {
+    EffectEntry* entry = find_effect(vs_path, fs_path);
+    if (entry == nullptr) {
+        std::unique_ptr<EffectEntry> loaded(new EffectEntry());
+        if (!loaded->effect.load_from_file(vs_path, fs_path))
+            return nullptr;
+
+        loaded->vs_path = vs_path;
+        loaded->fs_path = fs_path;
+        entry = loaded.get();
+        m_effects.push_back(std::move(loaded));
+    }
+
+    ++entry->references;
+    return &entry->effect;
+}
+
+void ResourceCache::release_effect(const char* vs_path, const char* fs_path) {
+    EffectEntry* entry = find_effect(vs_path, fs_path);
+    if (entry != nullptr && entry->references > 0)
+        --entry->references;
+}
+
+const Entity::Mesh* ResourceCache::acquire_quad(const char* texture_path, float z) {
+    QuadEntry* entry = find_quad(texture_path, z);
+    if (entry != nullptr) {
+        ++entry->references;
+        return &entry->mesh;
+    }
+
+    const Texture* texture = acquire_texture(texture_path);
+    if (texture == nullptr)
+        return nullptr;
+
+    // The position corresponds to the center of the texture
+    float wr = texture->width * 0.5f;
+    float hr = texture->height * 0.5f;
+
+    TexturedVertex vertices[4];
+    vertices[0].position = { -wr, +hr, z };
+    vertices[0].texcoord = { 0.f, 1.f };
+    vertices[1].position = { +wr, +hr, z };
+    vertices[1].texcoord = { 1.f, 1.f };
+    vertices[2].position = { +wr, -hr, z };
+    vertices[2].texcoord = { 1.f, 0.f };
+    vertices[3].position = { -wr, -hr, z };
+    vertices[3].texcoord = { 0.f, 0.f };
+
+    // Counterclockwise as it's the default opengl front winding direction
+    uint16_t indices[] = { 0, 3, 1, 1, 3, 2 };
+
+    // Clearing errors
+    gl_flush_errors();
+
+    std::unique_ptr<QuadEntry> loaded(new QuadEntry());
+    loaded->texture_path = texture_path;
+    loaded->z = z;
+
+    // Vertex Buffer creation
+    glGenBuffers(1, &loaded->mesh.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, loaded->mesh.vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(TexturedVertex) * 4, vertices, GL_STATIC_DRAW);
+
+    // Index Buffer creation
+    glGenBuffers(1, &loaded->mesh.ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, loaded->mesh.ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * 6, indices, GL_STATIC_DRAW);
+
+    // Vertex Array (Container for Vertex + Index buffer)
+    glGenVertexArrays(1, &loaded->mesh.vao);
+
+    if (gl_has_errors()) {
+        fprintf(stderr, "OpenGL errors occured while creating the quad for %s\n", texture_path);
+        free_quad(*loaded);
+        return nullptr;
+    }
+
+    loaded->references = 1;
+    entry = loaded.get();
+    m_quads.push_back(std::move(loaded));
+    return &entry->mesh;
+}
+
+void ResourceCache::release_quad(const char* texture_path, float z) {
+    QuadEntry* entry = find_quad(texture_path, z);
+    if (entry != nullptr && entry->references > 0)
+        --entry->references;
+}
+
+const ResourceCache::ColoredMesh* ResourceCache::acquire_mesh(const char* path) {
+    MeshEntry* entry = find_mesh(path);
+    if (entry != nullptr) {
+        ++entry->references;
+        return &entry->mesh;
+    }
+
+    // The mapping is only needed until the buffers are filled
+    MappedMeshFile file;
+    if (!file.open(path))
+        return nullptr;
+    const MeshFileHeader& header = file.get_header();
+
+    // Clearing errors
+    gl_flush_errors();
+
+    std::unique_ptr<MeshEntry> loaded(new MeshEntry());
+    loaded->path = path;
+    loaded->mesh.index_count = (GLsizei) header.index_count;
+    loaded->mesh.bounds = header.bounds;
+    loaded->mesh.points.resize(header.vertex_count);
+    for (uint32_t i = 0; i < header.vertex_count; ++i)
+        loaded->mesh.points[i] = { file.get_vertices()[i].position.x, file.get_vertices()[i].position.y };
+
+    // Vertex Buffer creation
+    glGenBuffers(1, &loaded->mesh.mesh.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, loaded->mesh.mesh.vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * header.vertex_count, file.get_vertices(), GL_STATIC_DRAW);
+
+    // Index Buffer creation
+    glGenBuffers(1, &loaded->mesh.mesh.ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, loaded->mesh.mesh.ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * header.index_count, file.get_indices(), GL_STATIC_DRAW);
+
+    // Vertex Array (Container for Vertex + Index buffer)
+    glGenVertexArrays(1, &loaded->mesh.mesh.vao);
+
+    if (gl_has_errors()) {
+        fprintf(stderr, "OpenGL errors occured while creating the mesh for %s\n", path);
+        free_mesh(*loaded);
+        return nullptr;
+    }
+
+    loaded->references = 1;
+    entry = loaded.get();
+    m_meshes.push_back(std::move(loaded));
+    return &entry->mesh;
+}
+
+void ResourceCache::release_mesh(const char* path) {
+    MeshEntry* entry = find_mesh(path);
+    if (entry != nullptr && entry->references > 0)
+        --entry->references;
+}
+
+ResourceCache::TextureEntry* ResourceCache::find_texture(const char* path) {
+    for (auto& entry : m_textures)
+        if (entry->path == path)
+            return entry.get();
+    return nullptr;
+}
+
+ResourceCache::EffectEntry* ResourceCache::find_effect(const char* vs_path, const char* fs_path) {
+    for (auto& entry : m_effects)
+        if (entry->vs_path == vs_path && entry->fs_path == fs_path)
+            return entry.get();
+    return nullptr;
+}
+
+ResourceCache::QuadEntry* ResourceCache::find_quad(const char* texture_path, float z) {
+    for (auto& entry : m_quads)
+        if (entry->z == z && entry->texture_path == texture_path)
+            return entry.get();
+    return nullptr;
+}
+
+ResourceCache::MeshEntry* ResourceCache::find_mesh(const char* path) {
+    for (auto& entry : m_meshes)
+        if (entry->path == path)
+            return entry.get();
+    return nullptr;
+}
+
+void ResourceCache::free_quad(QuadEntry& entry) {
+    glDeleteBuffers(1, &entry.mesh.vbo);
+    glDeleteBuffers(1, &entry.mesh.ibo);
+    glDeleteVertexArrays(1, &entry.mesh.vao);
+    release_texture(entry.texture_path.c_str());
+}
+
+void ResourceCache::free_mesh(MeshEntry& entry) {
+    glDeleteBuffers(1, &entry.mesh.mesh.vbo);
+    glDeleteBuffers(1, &entry.mesh.mesh.ibo);
+    glDeleteVertexArrays(1, &entry.mesh.mesh.vao);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "common.hpp"
+#include "mesh_file.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// GPU resources shared between entities
+//
+// Textures, programs, quads and meshes are loaded the first time they are acquired and kept, keyed by
+// their paths, so spawning an entity only bumps a count instead of decoding a PNG and compiling
+// shaders. There are only a handful of them, lookups are a linear scan comparing the paths in
+// place, which doesn't allocate.
+// Every acquire must be paired with a release of the same key. A resource nobody holds anymore
+// stays loaded until purge(), entities come and go all the time and would otherwise reload
+// everything whenever the last one of a kind dies. The returned pointers stay valid until the
+// resource is freed.
+class ResourceCache
+{
+public:
+    // Frees every resource, held or not
+    void destroy();
+
+    // Frees the resources nobody holds anymore
+    void purge();
+
+    const Texture* acquire_texture(const char* path);
+    void release_texture(const char* path);
+
+    // Program linked from the two shaders
+    const Entity::Effect* acquire_effect(const char* vs_path, const char* fs_path);
+    void release_effect(const char* vs_path, const char* fs_path);
+
+    // TexturedVertex quad the size of the texture at texture_path, centered on the origin at depth z
+    const Entity::Mesh* acquire_quad(const char* texture_path, float z);
+    void release_quad(const char* texture_path, float z);
+
+    // Vertex mesh mapped from a binary mesh file, uploaded as is. The positions are kept on the
+    // CPU for the collision code.
+    struct ColoredMesh {
+        Entity::Mesh mesh;
+        GLsizei index_count;
+        MeshBounds bounds;
+        std::vector<vec2> points; // x and y of the vertices
+    };
+    const ColoredMesh* acquire_mesh(const char* path);
+    void release_mesh(const char* path);
+
+private:
+    struct TextureEntry {
+        std::string path;
+        Texture texture;
+        int references = 0;
+    };
+
+    struct EffectEntry {
+        std::string vs_path;
+        std::string fs_path;
+        Entity::Effect effect;
+        int references = 0;
+    };
+
+    // A quad holds a reference on its texture for as long as it is loaded
+    struct QuadEntry {
+        std::string texture_path;
+        float z;
+        Entity::Mesh mesh;
+        int references = 0;
+    };
+
+    struct MeshEntry {
+        std::string path;
+        ColoredMesh mesh;
+        int references = 0;
+    };
+
+    TextureEntry* find_texture(const char* path);
+    EffectEntry* find_effect(const char* vs_path, const char* fs_path);
+    QuadEntry* find_quad(const char* texture_path, float z);
+    MeshEntry* find_mesh(const char* path);
+
+    void free_quad(QuadEntry& entry);
+    void free_mesh(MeshEntry& entry);
+
+    // Entries are allocated one by one so that the returned pointers survive the vectors growing
+    std::vector<std::unique_ptr<TextureEntry>> m_textures;
+    std::vector<std::unique_ptr<EffectEntry>> m_effects;
+    std::vector<std::unique_ptr<QuadEntry>> m_quads;
+    std::vector<std::unique_ptr<MeshEntry>> m_meshes;
+};
@@ -2,8 +2,7 @@
 #include "salmon.hpp"
 
 // internal
-#include "turtle.hpp"
-#include "fish.hpp"
+#include "convex_hull.hpp"
 
 // stlib
 #include <string>
@@ -13,82 +12,36 @@
 #include <iostream>
 #define PI 3.14159265
 
-bool Salmon::init(vec2 x_level_bounds, vec2 y_level_bounds)
+bool Salmon::init(ResourceCache& resources, vec2 x_level_bounds, vec2 y_level_bounds)
 {
-	m_vertices.clear();
-  	m_indices.clear();
-
-	// Reads the salmon mesh from a file, which contains a list of vertices and indices
-	FILE* mesh_file = fopen(mesh_path("salmon.mesh"), "r");
-	if (mesh_file == nullptr)
+	m_resources = &resources;
+	m_has_mesh = false;
+	m_has_effect = false;
+
+	// Maps the binary mesh converted from salmon.mesh by mesh_convert, it stays in the cache
+	// so resetting the world doesn't go back to the disk
+	const ResourceCache::ColoredMesh* shared_mesh = m_resources->acquire_mesh(mesh_path("salmon.smesh"));
+	if (shared_mesh == nullptr)
 		return false;
+	mesh = shared_mesh->mesh;
+	m_index_count = shared_mesh->index_count;
+	m_has_mesh = true;
 
-	// Reading vertices and colors
-	size_t num_vertices;
-	fscanf(mesh_file, "%zu\n", &num_vertices);
-
-	m_mouth_vec = {0, 0};
-    m_left_vec = {0, 0};
-    m_top_vec = {0, 0};
-    m_bottom_vec = {0, 0};
-
-	for (size_t i = 0; i < num_vertices; ++i)
-	{
-		float x, y, z;
-		float _u[3]; // unused
-		int r, g, b;
-		fscanf(mesh_file, "%f %f %f %f %f %f %d %d %d\n", &x, &y, &z, _u, _u+1, _u+2, &r, &g, &b);
-		Vertex vertex;
-		vertex.position = { x, y, -z };
-		vertex.color = { (float)r / 255, (float)g / 255, (float)b / 255 };
-		m_vertices.push_back(vertex);
-
-		if (x < m_mouth_vec.x)
-		    m_mouth_vec = {x, y};
-        if (x > m_left_vec.x)
-            m_left_vec = {x, y};
-        if (y < m_top_vec.y)
-            m_top_vec = {x, y};
-        if (y > m_bottom_vec.y)
-            m_bottom_vec = {x, y};
-	}
-
-    // Reading associated indices
-	size_t num_indices;
-	fscanf(mesh_file, "%zu\n", &num_indices);
-	for (size_t i = 0; i < num_indices; ++i)
-	{
-		int idx[3];
-		fscanf(mesh_file, "%d %d %d\n", idx, idx + 1, idx + 2);
-		m_indices.push_back((uint16_t)idx[0]);
-		m_indices.push_back((uint16_t)idx[1]);
-		m_indices.push_back((uint16_t)idx[2]);
-	}
-
-	// Done reading
-	fclose(mesh_file);
+	m_mouth_vec = shared_mesh->bounds.min_x_vertex;
+	m_left_vec = shared_mesh->bounds.max_x_vertex;
+	m_top_vec = shared_mesh->bounds.min_y_vertex;
+	m_bottom_vec = shared_mesh->bounds.max_y_vertex;
 
-	// Clearing errors
-	gl_flush_errors();
-
-	// Vertex Buffer creation
-	glGenBuffers(1, &mesh.vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * m_vertices.size(), m_vertices.data(), GL_STATIC_DRAW);
-
-	// Index Buffer creation
-	glGenBuffers(1, &mesh.ibo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * m_indices.size(), m_indices.data(), GL_STATIC_DRAW);
-
-	// Vertex Array (Container for Vertex + Index buffer)
-	glGenVertexArrays(1, &mesh.vao);
-	if (gl_has_errors())
-		return false;
+	// Convex hull of the mesh for the collision tests, only its corners are transformed
+	m_hull = convex_hull(shared_mesh->points);
+	m_transformed_hull.resize(m_hull.size());
 
 	// Loading shaders
-	if (!effect.load_from_file(shader_path("salmon.vs.glsl"), shader_path("salmon.fs.glsl")))
+	const Effect* shared_effect = m_resources->acquire_effect(shader_path("salmon.vs.glsl"), shader_path("salmon.fs.glsl"));
+	if (shared_effect == nullptr)
 		return false;
+	effect = *shared_effect;
+	m_has_effect = true;
 	
 	// Setting initial values
 	motion.position = { 300.f, 400.f };
@@ -100,7 +53,7 @@ bool Salmon::init(vec2 x_level_bounds, vec2 y_level_bounds)
 	m_is_alive = true;
 	m_light_up_countdown_ms = -1.f;
 	m_velocity = {0.f, 0.f};
-	m_move_speed = 3.f;
+	m_move_speed = 180.f; // pixels per second
 
     m_x_level_bounds = x_level_bounds;
     m_y_level_bounds = y_level_bounds;
@@ -108,22 +61,28 @@ bool Salmon::init(vec2 x_level_bounds, vec2 y_level_bounds)
     m_x_bounds = {-4.2, 4.2};
     m_y_bounds = {-3.8, 4.0};
 
-    m_rotate_amount = 0.035;
+    m_rotate_amount = 2.1f; // radians per second
     m_rotate = false;
 
+    // Nothing to interpolate from until the first update
+    save_motion();
+
     return true;
 }
 
 // Releases all graphics resources
 void Salmon::destroy()
 {
-	glDeleteBuffers(1, &mesh.vbo);
-	glDeleteBuffers(1, &mesh.ibo);
-	glDeleteBuffers(1, &mesh.vao);
+	// The cache owns the GL objects, they are only freed once nobody holds them
+	if (m_has_mesh) {
+		m_resources->release_mesh(mesh_path("salmon.smesh"));
+		m_has_mesh = false;
+	}
 
-	glDeleteShader(effect.vertex);
-	glDeleteShader(effect.fragment);
-	glDeleteShader(effect.program);
+	if (m_has_effect) {
+		m_resources->release_effect(shader_path("salmon.vs.glsl"), shader_path("salmon.fs.glsl"));
+		m_has_effect = false;
+	}
 }
 
 // Called on each frame by World::update()
@@ -136,10 +95,10 @@ void Salmon::update(float ms)
 		// UPDATE SALMON POSITION HERE BASED ON KEY PRESSED (World::on_key())
 		// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 		if (m_rotate) {
-		    motion.radians += m_rotate_direction * m_rotate_amount;
+		    motion.radians += m_rotate_direction * m_rotate_amount * (ms / 1000);
 		}
 
-		move(mul(m_velocity, m_move_speed));
+		move(mul(m_velocity, m_move_speed * (ms / 1000)));
 	}
 	else
 	{
@@ -154,20 +113,13 @@ void Salmon::update(float ms)
 
 void Salmon::draw(const mat3& projection)
 {
-	transform.begin();
-
 	// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 	// SALMON TRANSFORMATION CODE HERE
 
 	// see Transformations and Rendering in the specification pdf
-	// the following functions are available:
-	transform.translate(motion.position);
-	transform.rotate(motion.radians);
-	transform.scale(physics.scale);
+	transform.set(get_draw_position(), get_draw_radians(), physics.scale);
 	// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 
-	transform.end();
-
 	// Setting shaders
 	glUseProgram(effect.program);
 
@@ -215,47 +167,17 @@ void Salmon::draw(const mat3& projection)
 		light_up = 1;
 	glUniform1iv(light_up_uloc, 1, &light_up);
 
-	// Get number of infices from buffer,
-	// we know our vbo contains both colour and position information, so...
-	GLint size = 0;
-	glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
-	glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
-	GLsizei num_indices = size / sizeof(uint16_t);
-
 	// Drawing!
-	glDrawElements(GL_TRIANGLES, num_indices, GL_UNSIGNED_SHORT, nullptr);
-}
-
-// Simple bounding box collision check
-// This is a SUPER APPROXIMATE check that puts a circle around the bounding boxes and sees
-// if the center point of either object is inside the other's bounding-box-circle. You don't
-// need to try to use this technique.
-bool Salmon::collides_with(const Turtle& turtle)
-{
-	float dx = motion.position.x - turtle.get_position().x;
-	float dy = motion.position.y - turtle.get_position().y;
-	float d_sq = dx * dx + dy * dy;
-	float other_r = std::max(turtle.get_bounding_box().x, turtle.get_bounding_box().y);
-	float my_r = std::max(physics.scale.x, physics.scale.y);
-	float r = std::max(other_r, my_r);
-	r *= 0.6f;
-	if (d_sq < r * r)
-		return true;
-	return false;
+	glDrawElements(GL_TRIANGLES, m_index_count, GL_UNSIGNED_SHORT, nullptr);
 }
 
-bool Salmon::collides_with(const Fish& fish)
+// Separating axis test of the salmon hull against the bounding box of a turtle or fish
+bool Salmon::collides_with_box(vec2 center, vec2 size)
 {
-	float dx = motion.position.x - fish.get_position().x;
-	float dy = motion.position.y - fish.get_position().y;
-	float d_sq = dx * dx + dy * dy;
-	float other_r = std::max(fish.get_bounding_box().x, fish.get_bounding_box().y);
-	float my_r = std::max(physics.scale.x, physics.scale.y);
-	float r = std::max(other_r, my_r);
-	r *= 0.6f;
-	if (d_sq < r * r)
-		return true;
-	return false;
+	vec2 half = mul(size, 0.5f);
+	transform_hull();
+	return hull_overlaps_box(m_transformed_hull.data(), m_transformed_hull.size(),
+		sub(center, half), add(center, half));
 }
 
 // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
@@ -281,21 +203,19 @@ bool Salmon::bounding_box_collision() {
 bool Salmon::mesh_collision() {
     m_collision_points.clear();
 
-    mat3 trans = get_transformation_matrix();
+    // The walls are half planes, the hull crosses one only if one of its corners does
+    transform_hull();
 
     bool hit = false;
-    int index = 0;
-    for (auto vert : m_vertices) {
-        vert.position.z = 1.f;
-        vec3 trans_vert = mul(trans, vert.position);
+    for (size_t i = 0; i < m_transformed_hull.size(); ++i) {
+        vec2 trans_vert = m_transformed_hull[i];
         if (trans_vert.x < m_x_level_bounds.x ||
             trans_vert.x > m_x_level_bounds.y ||
             trans_vert.y < m_y_level_bounds.x ||
             trans_vert.y > m_y_level_bounds.y) {
-                m_collision_points.push_front({vert.position.x, vert.position.y});
+                m_collision_points.push_front(m_hull[i]);
                 hit = true;
         }
-        index++;
     }
     return hit;
 }
@@ -348,16 +268,15 @@ void Salmon::reverse_direction(vec2 velocity) {
     if (!isnan(theta))
         motion.radians = theta;
 
-    mat3 trans = get_transformation_matrix();
+    // The hull has the same extents as the mesh
+    transform_hull();
 
     float min_x = 10000;
     float max_x = 0;
     float min_y = 10000;
     float max_y = 0;
 
-    for (auto vert : m_vertices) {
-        vert.position.z = 1.f;
-        vec3 trans_vert = mul(trans, vert.position);
+    for (auto trans_vert : m_transformed_hull) {
         if (trans_vert.x < min_x)
             min_x = trans_vert.x;
         if (trans_vert.x > max_x)
@@ -442,13 +361,13 @@ std::list<vec2> Salmon::get_collision_points (){
     return m_collision_points;
 }
 
-mat3 Salmon::get_transformation_matrix() {
-    transform.begin();
-    transform.translate(motion.position);
-    transform.rotate(motion.radians);
-    transform.scale(physics.scale);
-    transform.end();
-    return transform.out;
+// Current motion, collisions must not depend on how far drawing is interpolated
+affine2 Salmon::get_transformation_matrix() {
+    return affine2::from_trs(motion.position, motion.radians, physics.scale);
+}
+
+void Salmon::transform_hull() {
+    transform_points(get_transformation_matrix(), m_hull.data(), m_transformed_hull.data(), m_hull.size());
 }
 
 vec2 Salmon::get_velocity() {
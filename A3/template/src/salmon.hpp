@@ -1,17 +1,16 @@
 #pragma once
 
 #include "common.hpp"
+#include "resource_cache.hpp"
 #include <vector>
 #include <list>
 
-class Turtle;
-class Fish;
-
 class Salmon : public Entity
 {
 public:
-	// Creates all the associated render resources and default transform
-	bool init(vec2 x_level_bounds, vec2 y_level_bounds);
+	// Creates all the associated render resources and default transform, the mesh and shaders
+	// are kept in resources across resets
+	bool init(ResourceCache& resources, vec2 x_level_bounds, vec2 y_level_bounds);
 
 	// Releases all associated resources
 	void destroy();
@@ -23,9 +22,8 @@ public:
 	// Renders the salmon
 	void draw(const mat3& projection)override;
 
-	// Collision routines for turtles and fish
-	bool collides_with(const Turtle& turtle);
-	bool collides_with(const Fish& fish);
+	// Collision routine for turtles and fish, against their bounding box of size around center
+	bool collides_with_box(vec2 center, vec2 size);
     bool collides_with_wall();
 
 	// Returns the current salmon position
@@ -64,7 +62,8 @@ public:
 
     vec2 get_mouth_pos();
 
-    mat3 get_transformation_matrix();
+    // Current position, rotation and scale, not the interpolated ones draw() uses
+    affine2 get_transformation_matrix();
 
     std::list<vec2> get_collision_points();
 
@@ -81,6 +80,9 @@ private:
 	bool bounding_box_collision();
     bool mesh_collision();
 
+    // Moves the hull corners to where the salmon currently is, into m_transformed_hull
+    void transform_hull();
+
 	vec2 m_velocity;
 	vec2 m_x_level_bounds;
     vec2 m_y_level_bounds;
@@ -106,7 +108,12 @@ private:
     int m_rotate_direction;
     float m_rotate_amount;
 
-  	std::vector<Vertex> m_vertices;
-	std::vector<uint16_t> m_indices;
+	ResourceCache* m_resources;
+	bool m_has_mesh;
+	bool m_has_effect;
+	GLsizei m_index_count;
+
+	std::vector<vec2> m_hull; // convex hull of the mesh, in mesh coordinates
+	std::vector<vec2> m_transformed_hull;
 	std::list<vec2> m_collision_points;
 };
@@ -0,0 +1,74 @@
+// Header
+#include "slot_map.hpp"
+
+size_t SlotMap::size() const {
+    return m_slots.size();
+}
+
+void SlotMap::reserve(size_t count) {
+    m_generations.reserve(count);
+    m_indices.reserve(count);
+    m_slots.reserve(count);
+    m_free_slots.reserve(count);
+}
+
+void SlotMap::clear() {
+    truncate(0);
+}
+
+EntityHandle SlotMap::insert() {
+    uint32_t slot;
+    if (!m_free_slots.empty()) {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+    } else {
+        slot = (uint32_t) m_generations.size();
+        m_generations.push_back(0);
+        m_indices.push_back(0);
+    }
+
+    m_indices[slot] = (uint32_t) m_slots.size();
+    m_slots.push_back(slot);
+
+    EntityHandle handle;
+    handle.slot = slot;
+    handle.generation = m_generations[slot];
+    return handle;
+}
+
+void SlotMap::remove(size_t index) {
+    release(index);
+
+    uint32_t moved = m_slots.back();
+    m_slots[index] = moved;
+    m_indices[moved] = (uint32_t) index;
+    m_slots.pop_back();
+}
+
+void SlotMap::truncate(size_t count) {
+    for (size_t i = count; i < m_slots.size(); ++i)
+        release(i);
+    if (count < m_slots.size())
+        m_slots.resize(count);
+}
+
+bool SlotMap::find(EntityHandle handle, size_t& index) const {
+    if (handle.slot >= m_generations.size() || m_generations[handle.slot] != handle.generation)
+        return false;
+
+    index = m_indices[handle.slot];
+    return true;
+}
+
+EntityHandle SlotMap::get_handle(size_t index) const {
+    EntityHandle handle;
+    handle.slot = m_slots[index];
+    handle.generation = m_generations[handle.slot];
+    return handle;
+}
+
+void SlotMap::release(size_t index) {
+    uint32_t slot = m_slots[index];
+    ++m_generations[slot];
+    m_free_slots.push_back(slot);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Stable reference to an entity of a store, see SlotMap
+struct EntityHandle {
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+// Generational handles for the entities of a store kept by component (SpriteStore, PebbleStore)
+//
+// The stores keep their entities dense so that the update loops stream through contiguous arrays,
+// which means removing an entity moves the last one into its slot and an index is only good until
+// the next removal. A handle names a slot of this map instead, which follows its entity wherever
+// the store moves it. When the entity is removed the slot's generation is bumped, so handles to
+// it stop resolving, and the slot goes to a free list to be handed out by the next insert.
+// Once the store has been at its peak size, spawning and removing allocate nothing.
+//
+// The map mirrors the store: every add to the store is an insert here and every swap removal a
+// remove with the same index.
+class SlotMap
+{
+public:
+    size_t size() const;
+
+    // Room for count entities without reallocating
+    void reserve(size_t count);
+
+    // Removes every entity, all the handles stop resolving
+    void clear();
+
+    // Handle for the entity just added at index size()
+    EntityHandle insert();
+
+    // The handle of index stops resolving and the last entity moves into index
+    void remove(size_t index);
+
+    // Keeps the first count entities
+    void truncate(size_t count);
+
+    // Current index of the entity, false if it was removed
+    bool find(EntityHandle handle, size_t& index) const;
+
+    EntityHandle get_handle(size_t index) const;
+
+private:
+    // Frees the slot of the entity at index
+    void release(size_t index);
+
+    std::vector<uint32_t> m_generations; // per slot
+    std::vector<uint32_t> m_indices;     // per slot, index of its entity in the store
+    std::vector<uint32_t> m_slots;       // per entity index, the slot naming it
+    std::vector<uint32_t> m_free_slots;
+};
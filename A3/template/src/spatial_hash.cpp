@@ -0,0 +1,89 @@
+// Header
+#include "spatial_hash.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+bool SpatialHash::init(float cell_size) {
+    m_cell_size = cell_size;
+    clear();
+    return true;
+}
+
+void SpatialHash::clear() {
+    m_entries.clear();
+    m_cells.clear();
+}
+
+void SpatialHash::insert(int type, int index, vec2 min, vec2 max) {
+    Entry entry;
+    entry.min = min;
+    entry.max = max;
+    entry.proxy = {type, index};
+    m_entries.push_back(entry);
+
+    int id = (int) m_entries.size() - 1;
+    int x1 = cell_coord(max.x);
+    int y1 = cell_coord(max.y);
+    for (int y = cell_coord(min.y); y <= y1; ++y)
+        for (int x = cell_coord(min.x); x <= x1; ++x)
+            m_cells.push_back({cell_key(x, y), id});
+}
+
+void SpatialHash::find_pairs(std::vector<Pair>& pairs) {
+    pairs.clear();
+
+    std::sort(m_cells.begin(), m_cells.end(), [](const CellEntry& l, const CellEntry& r) {
+        return l.cell < r.cell || (l.cell == r.cell && l.entry < r.entry);
+    });
+
+    size_t begin = 0;
+    while (begin < m_cells.size()) {
+        size_t end = begin + 1;
+        while (end < m_cells.size() && m_cells[end].cell == m_cells[begin].cell)
+            ++end;
+
+        for (size_t i = begin; i < end; ++i) {
+            for (size_t j = i + 1; j < end; ++j) {
+                const Entry& a = m_entries[m_cells[i].entry];
+                const Entry& b = m_entries[m_cells[j].entry];
+
+                if (a.proxy.type == b.proxy.type ||
+                    a.max.x < b.min.x || b.max.x < a.min.x || a.max.y < b.min.y || b.max.y < a.min.y)
+                    continue;
+
+                // Two boxes can share several cells, the pair is only reported by the one
+                // holding the corner of their intersection
+                int x = cell_coord(std::max(a.min.x, b.min.x));
+                int y = cell_coord(std::max(a.min.y, b.min.y));
+                if (cell_key(x, y) != m_cells[begin].cell)
+                    continue;
+
+                if (a.proxy.type < b.proxy.type)
+                    pairs.push_back({a.proxy, b.proxy});
+                else
+                    pairs.push_back({b.proxy, a.proxy});
+            }
+        }
+
+        begin = end;
+    }
+
+    std::sort(pairs.begin(), pairs.end(), [](const Pair& l, const Pair& r) {
+        if (l.a.type != r.a.type)
+            return l.a.type < r.a.type;
+        if (l.b.type != r.b.type)
+            return l.b.type < r.b.type;
+        if (l.a.index != r.a.index)
+            return l.a.index < r.a.index;
+        return l.b.index < r.b.index;
+    });
+}
+
+int SpatialHash::cell_coord(float position) const {
+    return (int) std::floor(position / m_cell_size);
+}
+
+uint64_t SpatialHash::cell_key(int x, int y) const {
+    return ((uint64_t) (uint32_t) x << 32) | (uint32_t) y;
+}
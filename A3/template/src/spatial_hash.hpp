@@ -0,0 +1,57 @@
+#pragma once
+
+#include "common.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Uniform grid broadphase
+//
+// Every proxy is an axis aligned box registered in all the grid cells it touches. Cells are
+// keyed by their coordinates and sorted, so the proxies sharing a cell end up next to each
+// other and only those are tested against each other. The grid is meant to be cleared and
+// filled again every frame.
+class SpatialHash
+{
+public:
+    // Whatever the caller uses to find the entity back, proxies of the same type never pair
+    struct Proxy {
+        int type;
+        int index;
+    };
+
+    // a.type < b.type
+    struct Pair {
+        Proxy a;
+        Proxy b;
+    };
+
+    bool init(float cell_size);
+
+    // Removes all the proxies
+    void clear();
+
+    void insert(int type, int index, vec2 min, vec2 max);
+
+    // Overlapping proxies of different types, each pair once, sorted by type then index
+    void find_pairs(std::vector<Pair>& pairs);
+
+private:
+    struct Entry {
+        vec2 min;
+        vec2 max;
+        Proxy proxy;
+    };
+
+    struct CellEntry {
+        uint64_t cell;
+        int entry;
+    };
+
+    int cell_coord(float position) const;
+    uint64_t cell_key(int x, int y) const;
+
+    float m_cell_size;
+    std::vector<Entry> m_entries;
+    std::vector<CellEntry> m_cells;
+};
@@ -0,0 +1,157 @@
+// Header
+#include "sprite_batch.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    // Sizes the instance buffer before it first grows
+    const size_t INITIAL_SPRITES = 64;
+    const size_t INSTANCE_FRAMES = 3;
+
+    // Attribute locations in sprite.vs.glsl
+    const GLuint IN_POSITION = 0;
+    const GLuint IN_TEXCOORD = 1;
+    const GLuint IN_TRANSFORM = 2;
+    const GLuint IN_COLOR = 5;
+    const GLuint IN_UV_RECT = 6;
+}
+
+bool SpriteBatch::init() {
+    // Unit quad, scaled to the sprite size by the instance transform
+    TexturedVertex vertices[4];
+    vertices[0].position = { -0.5f, +0.5f, -0.02f };
+    vertices[0].texcoord = { 0.f, 1.f };
+    vertices[1].position = { +0.5f, +0.5f, -0.02f };
+    vertices[1].texcoord = { 1.f, 1.f };
+    vertices[2].position = { +0.5f, -0.5f, -0.02f };
+    vertices[2].texcoord = { 1.f, 0.f };
+    vertices[3].position = { -0.5f, -0.5f, -0.02f };
+    vertices[3].texcoord = { 0.f, 0.f };
+
+    // Counterclockwise as it's the default opengl front winding direction
+    uint16_t indices[] = { 0, 3, 1, 1, 3, 2 };
+
+    // Clearing errors
+    gl_flush_errors();
+
+    glGenVertexArrays(1, &mesh.vao);
+    glBindVertexArray(mesh.vao);
+
+    glGenBuffers(1, &mesh.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(TexturedVertex) * 4, vertices, GL_STATIC_DRAW);
+
+    glGenBuffers(1, &mesh.ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * 6, indices, GL_STATIC_DRAW);
+
+    if (gl_has_errors())
+        return false;
+
+    if (!m_instance_buffer.init(INITIAL_SPRITES * sizeof(Instance), INSTANCE_FRAMES))
+        return false;
+
+    return effect.load_from_file(shader_path("sprite.vs.glsl"), shader_path("sprite.fs.glsl"));
+}
+
+void SpriteBatch::destroy() {
+    glDeleteBuffers(1, &mesh.vbo);
+    glDeleteBuffers(1, &mesh.ibo);
+    glDeleteVertexArrays(1, &mesh.vao);
+    m_instance_buffer.destroy();
+
+    effect.release();
+    m_batches.clear();
+}
+
+void SpriteBatch::add(const Texture& texture, const AtlasRegion& region, const affine2& transform, vec3 color) {
+    Batch* batch = nullptr;
+    for (auto& existing : m_batches) {
+        if (existing.texture == &texture) {
+            batch = &existing;
+            break;
+        }
+    }
+
+    if (batch == nullptr) {
+        m_batches.push_back({&texture, {}});
+        batch = &m_batches.back();
+    }
+
+    Instance instance;
+    instance.transform = transform;
+    instance.transform.x_axis = mul(transform.x_axis, region.size.x);
+    instance.transform.y_axis = mul(transform.y_axis, region.size.y);
+    instance.color = color;
+    instance.uv_min = region.uv_min;
+    instance.uv_max = region.uv_max;
+    batch->instances.push_back(instance);
+}
+
+void SpriteBatch::draw(const mat3& projection) {
+    // Enabling alpha channel for textures
+    glEnable(GL_BLEND); glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_DEPTH_TEST);
+
+    // Setting shaders
+    glUseProgram(effect.program);
+
+    // Getting uniform locations for glUniform* calls
+    GLint projection_uloc = glGetUniformLocation(effect.program, "projection");
+    glUniformMatrix3fv(projection_uloc, 1, GL_FALSE, (float*)&projection);
+
+    // Setting vertices and indices
+    glBindVertexArray(mesh.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
+
+    glEnableVertexAttribArray(IN_POSITION);
+    glEnableVertexAttribArray(IN_TEXCOORD);
+    glVertexAttribPointer(IN_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(TexturedVertex), (void*)0);
+    glVertexAttribPointer(IN_TEXCOORD, 2, GL_FLOAT, GL_FALSE, sizeof(TexturedVertex), (void*)sizeof(vec3));
+
+    glActiveTexture(GL_TEXTURE0);
+
+    for (auto& batch : m_batches) {
+        if (batch.instances.empty())
+            continue;
+
+        size_t bytes = batch.instances.size() * sizeof(Instance);
+        void* instances = m_instance_buffer.map(bytes);
+        if (instances == nullptr) {
+            batch.instances.clear();
+            continue;
+        }
+        memcpy(instances, batch.instances.data(), bytes);
+        size_t offset = m_instance_buffer.unmap();
+
+        // Per sprite transform columns (the two axes and the translation), colour and region
+        for (GLuint column = 0; column < 3; ++column) {
+            glEnableVertexAttribArray(IN_TRANSFORM + column);
+            glVertexAttribPointer(IN_TRANSFORM + column, 2, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                                  (void*)(offset + offsetof(Instance, transform) + column * sizeof(vec2)));
+            glVertexAttribDivisor(IN_TRANSFORM + column, 1);
+        }
+        glEnableVertexAttribArray(IN_COLOR);
+        glVertexAttribPointer(IN_COLOR, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(offset + offsetof(Instance, color)));
+        glVertexAttribDivisor(IN_COLOR, 1);
+        glEnableVertexAttribArray(IN_UV_RECT);
+        glVertexAttribPointer(IN_UV_RECT, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(offset + offsetof(Instance, uv_min)));
+        glVertexAttribDivisor(IN_UV_RECT, 1);
+
+        glBindTexture(GL_TEXTURE_2D, batch.texture->id);
+
+        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, nullptr, (GLsizei)batch.instances.size());
+
+        batch.instances.clear();
+    }
+
+    // Reset divisors
+    for (GLuint column = 0; column < 3; ++column)
+        glVertexAttribDivisor(IN_TRANSFORM + column, 0);
+    glVertexAttribDivisor(IN_COLOR, 0);
+    glVertexAttribDivisor(IN_UV_RECT, 0);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "common.hpp"
+#include "stream_buffer.hpp"
+#include "texture_atlas.hpp"
+
+#include <vector>
+
+// Collects textured quads and draws all the ones sharing a texture with a single instanced
+// draw call. Each sprite has its own transform, colour and region of the texture, so an entity
+// only has to queue itself instead of setting up the whole pipeline, and sprites cut from the
+// same atlas all go in one call.
+class SpriteBatch : public Entity
+{
+public:
+    bool init();
+
+    void destroy();
+
+    // Queues a sprite, drawn with the region of texture, at the size of the region, centered on
+    // the origin of transform
+    void add(const Texture& texture, const AtlasRegion& region, const affine2& transform, vec3 color);
+
+    // Draws the queued sprites, one call per texture in the order they were first queued, and
+    // empties the batch
+    void draw(const mat3& projection) override;
+
+private:
+    struct Instance {
+        affine2 transform; // scaled by the size of the region, the quad is a unit square
+        vec3 color;
+        vec2 uv_min;
+        vec2 uv_max;
+    };
+
+    struct Batch {
+        const Texture* texture;
+        std::vector<Instance> instances;
+    };
+
+    std::vector<Batch> m_batches;
+    StreamBuffer m_instance_buffer;
+};
@@ -0,0 +1,90 @@
+// Header
+#include "sprite_store.hpp"
+
+#include <cmath>
+
+vec2 SpriteSkin::get_size() const {
+    // fabs is to avoid negative scale due to the facing direction
+    return { std::fabs(scale.x) * region->size.x, std::fabs(scale.y) * region->size.y };
+}
+
+size_t SpriteStore::size() const {
+    return position_x.size();
+}
+
+bool SpriteStore::empty() const {
+    return position_x.empty();
+}
+
+void SpriteStore::clear() {
+    truncate(0);
+}
+
+void SpriteStore::reserve(size_t count) {
+    position_x.reserve(count);
+    position_y.reserve(count);
+    last_position_x.reserve(count);
+    last_position_y.reserve(count);
+    speed.reserve(count);
+    handles.reserve(count);
+}
+
+EntityHandle SpriteStore::add(vec2 position, float entity_speed) {
+    position_x.push_back(position.x);
+    position_y.push_back(position.y);
+    last_position_x.push_back(position.x);
+    last_position_y.push_back(position.y);
+    speed.push_back(entity_speed);
+    return handles.insert();
+}
+
+void SpriteStore::remove(size_t index) {
+    size_t last = size() - 1;
+    position_x[index] = position_x[last];
+    position_y[index] = position_y[last];
+    last_position_x[index] = last_position_x[last];
+    last_position_y[index] = last_position_y[last];
+    speed[index] = speed[last];
+    handles.remove(index);
+
+    position_x.pop_back();
+    position_y.pop_back();
+    last_position_x.pop_back();
+    last_position_y.pop_back();
+    speed.pop_back();
+}
+
+void SpriteStore::truncate(size_t count) {
+    if (count >= size())
+        return;
+    position_x.resize(count);
+    position_y.resize(count);
+    last_position_x.resize(count);
+    last_position_y.resize(count);
+    speed.resize(count);
+    handles.truncate(count);
+}
+
+vec2 SpriteStore::get_position(size_t index) const {
+    return { position_x[index], position_y[index] };
+}
+
+void SpriteStore::set_position(size_t index, vec2 position) {
+    position_x[index] = position.x;
+    position_y[index] = position.y;
+}
+
+void SpriteStore::save_positions() {
+    last_position_x = position_x;
+    last_position_y = position_y;
+}
+
+void SpriteStore::draw(SpriteBatch& batch, const Texture& texture, const SpriteSkin& skin, float alpha) const {
+    for (size_t i = 0; i < size(); ++i) {
+        vec2 position = {
+            last_position_x[i] * (1.f - alpha) + position_x[i] * alpha,
+            last_position_y[i] * (1.f - alpha) + position_y[i] * alpha
+        };
+        batch.add(texture, *skin.region, affine2::from_trs(position, 0.f, skin.scale), { 1.f, 1.f, 1.f });
+    }
+}
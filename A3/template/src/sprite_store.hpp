@@ -0,0 +1,59 @@
+#pragma once
+
+#include "common.hpp"
+#include "slot_map.hpp"
+#include "sprite_batch.hpp"
+#include "texture_atlas.hpp"
+
+#include <vector>
+
+// Look shared by all the entities of a store, a region of the sprite atlas drawn at scale
+struct SpriteSkin {
+    const AtlasRegion* region;
+    vec2 scale;
+
+    // Scaled size of the region
+    vec2 get_size() const;
+};
+
+// Turtles and fish stored by component instead of as one object each
+//
+// The components every update touches are one dense array per field, so the movement, collision
+// and AI loops stream through exactly what they use and thousands of entities stay cheap. What
+// all the entities of a store have in common, skin and base speed, is kept once by the system
+// that owns the store (Turtles, FishSchool) rather than copied into every entity.
+// Removing an entity moves the last one into its slot: indices are dense and are what the
+// broadphase and the pebbles refer to, but only until the next removal. What has to refer to an
+// entity across frames keeps its handle instead.
+struct SpriteStore {
+    std::vector<float> position_x;
+    std::vector<float> position_y;
+    std::vector<float> last_position_x; // before the last update, drawing interpolates from it
+    std::vector<float> last_position_y;
+    std::vector<float> speed;
+    SlotMap handles;
+
+    size_t size() const;
+    bool empty() const;
+    void clear();
+
+    // Room for count entities without reallocating
+    void reserve(size_t count);
+
+    // Adds an entity that hasn't moved yet at index size()
+    EntityHandle add(vec2 position, float entity_speed);
+    void remove(size_t index);
+
+    // Keeps the first count entities
+    void truncate(size_t count);
+
+    vec2 get_position(size_t index) const;
+    void set_position(size_t index, vec2 position);
+
+    // Where this update starts from, called before every update
+    void save_positions();
+
+    // Queues every entity with the skin cut from texture and no rotation, alpha of the way from
+    // its last position to the current one
+    void draw(SpriteBatch& batch, const Texture& texture, const SpriteSkin& skin, float alpha) const;
+};
@@ -0,0 +1,70 @@
+// Header
+#include "stream_buffer.hpp"
+
+namespace
+{
+    // Attribute offsets are kept aligned for the drivers that want it
+    const size_t ALIGNMENT = 16;
+}
+
+StreamBuffer::StreamBuffer() : m_vbo(0), m_size(0), m_frames_ahead(0), m_offset(0), m_mapped_offset(0),
+                               m_mapped_size(0) {
+}
+
+bool StreamBuffer::init(size_t frame_size, size_t frames_ahead) {
+    m_frames_ahead = frames_ahead;
+    m_size = frame_size * frames_ahead;
+
+    gl_flush_errors();
+    glGenBuffers(1, &m_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    orphan();
+
+    return !gl_has_errors();
+}
+
+void StreamBuffer::destroy() {
+    if (m_vbo != 0)
+        glDeleteBuffers(1, &m_vbo);
+    m_vbo = 0;
+}
+
+void* StreamBuffer::map(size_t size) {
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+
+    if (size > m_size / m_frames_ahead) {
+        m_size = size * m_frames_ahead;
+        orphan();
+    } else if (m_offset + size > m_size) {
+        orphan();
+    }
+
+    // Nothing is mapped until glMapBufferRange succeeds, so unmap() leaves a failed map alone
+    m_mapped_offset = m_offset;
+    m_mapped_size = 0;
+    if (size == 0)
+        return nullptr;
+
+    void* data = glMapBufferRange(GL_ARRAY_BUFFER, m_offset, size,
+                                  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (data == nullptr) {
+        fprintf(stderr, "Failed to map stream buffer\n");
+        return nullptr;
+    }
+
+    m_mapped_size = size;
+    return data;
+}
+
+size_t StreamBuffer::unmap() {
+    if (m_mapped_size > 0)
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+
+    m_offset = (m_mapped_offset + m_mapped_size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    return m_mapped_offset;
+}
+
+void StreamBuffer::orphan() {
+    glBufferData(GL_ARRAY_BUFFER, m_size, nullptr, GL_STREAM_DRAW);
+    m_offset = 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "common.hpp"
+
+// Vertex buffer written to every frame
+//
+// Each frame's data is appended after the previous one in a buffer several frames large and
+// mapped unsynchronized, so the driver never waits for the GPU to finish reading the ranges
+// still in flight. When the end is reached the storage is orphaned: the driver hands out a
+// fresh block and frees the old one once the GPU is done with it.
+class StreamBuffer
+{
+public:
+    StreamBuffer();
+
+    // Storage for frames_ahead frames of frame_size bytes, it grows when a frame needs more
+    bool init(size_t frame_size, size_t frames_ahead);
+
+    void destroy();
+
+    // Binds the buffer to GL_ARRAY_BUFFER and maps size bytes for writing. Returns nullptr when
+    // size is 0 or the map failed, the caller then has nothing to draw and skips unmap().
+    void* map(size_t size);
+
+    // Unmaps the range returned by the last successful map(), returns its offset in the buffer
+    size_t unmap();
+
+private:
+    void orphan();
+
+    GLuint m_vbo;
+    size_t m_size;
+    size_t m_frames_ahead;
+    size_t m_offset;
+    size_t m_mapped_offset;
+    size_t m_mapped_size;
+};
@@ -0,0 +1,155 @@
+// Header
+#include "texture_atlas.hpp"
+
+#include "../ext/stb_image/stb_image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    // Transparent pixels around every image
+    const int PADDING = 2;
+
+    int next_power_of_two(int n) {
+        int power = 1;
+        while (power < n)
+            power *= 2;
+        return power;
+    }
+}
+
+TextureAtlas::TextureAtlas() : m_decoded(0) {
+}
+
+void TextureAtlas::load(AssetLoader& loader, const std::vector<const char*>& paths) {
+    for (const char* path : paths) {
+        m_images.emplace_back(new Image{path, nullptr, 0, 0, 0, 0});
+        Image* image = m_images.back().get();
+        loader.submit([image] { decode(*image); }, [this] { ++m_decoded; });
+    }
+}
+
+bool TextureAtlas::is_decoded() const {
+    return m_decoded == m_images.size();
+}
+
+bool TextureAtlas::init(const std::vector<const char*>& paths) {
+    for (const char* path : paths) {
+        m_images.emplace_back(new Image{path, nullptr, 0, 0, 0, 0});
+        decode(*m_images.back());
+        ++m_decoded;
+    }
+    return upload();
+}
+
+bool TextureAtlas::upload() {
+    int area = 0;
+    int widest = 0;
+    bool decoded = true;
+    for (auto& image : m_images) {
+        if (image->pixels == nullptr) {
+            fprintf(stderr, "Failed to load atlas image %s\n", image->path.c_str());
+            decoded = false;
+            continue;
+        }
+        area += (image->width + PADDING) * (image->height + PADDING);
+        widest = std::max(widest, image->width);
+    }
+
+    if (!decoded) {
+        free_images();
+        return false;
+    }
+
+    // Rows of images, tallest first so that the rows waste little height
+    std::vector<Image*> order;
+    for (auto& image : m_images)
+        order.push_back(image.get());
+    std::stable_sort(order.begin(), order.end(), [](const Image* a, const Image* b) {
+        return a->height > b->height;
+    });
+
+    int width = std::max(widest + 2 * PADDING, next_power_of_two((int) std::ceil(std::sqrt((float) area))));
+    int x = PADDING;
+    int y = PADDING;
+    int row_height = 0;
+    for (Image* image : order) {
+        if (x + image->width + PADDING > width) {
+            x = PADDING;
+            y += row_height + PADDING;
+            row_height = 0;
+        }
+        image->x = x;
+        image->y = y;
+        x += image->width + PADDING;
+        row_height = std::max(row_height, image->height);
+    }
+    int height = y + row_height + PADDING;
+
+    std::vector<uint8_t> pixels((size_t) width * height * 4, 0);
+    m_paths.clear();
+    m_regions.clear();
+    for (auto& image : m_images) {
+        for (int row = 0; row < image->height; ++row) {
+            memcpy(&pixels[((size_t) (image->y + row) * width + image->x) * 4],
+                   image->pixels + (size_t) row * image->width * 4, (size_t) image->width * 4);
+        }
+
+        AtlasRegion region;
+        region.uv_min = { (float) image->x / width, (float) image->y / height };
+        region.uv_max = { (float) (image->x + image->width) / width, (float) (image->y + image->height) / height };
+        region.size = { (float) image->width, (float) image->height };
+        m_paths.push_back(image->path);
+        m_regions.push_back(region);
+    }
+    free_images();
+
+    gl_flush_errors();
+    glGenTextures(1, &m_texture.id);
+    glBindTexture(GL_TEXTURE_2D, m_texture.id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    m_texture.width = width;
+    m_texture.height = height;
+
+    return !gl_has_errors();
+}
+
+void TextureAtlas::destroy() {
+    if (m_texture.id != 0)
+        glDeleteTextures(1, &m_texture.id);
+    m_texture.id = 0;
+    free_images();
+    m_paths.clear();
+    m_regions.clear();
+}
+
+const AtlasRegion* TextureAtlas::find(const char* path) const {
+    for (size_t i = 0; i < m_paths.size(); ++i) {
+        if (m_paths[i] == path)
+            return &m_regions[i];
+    }
+    return nullptr;
+}
+
+const Texture& TextureAtlas::get_texture() const {
+    return m_texture;
+}
+
+void TextureAtlas::decode(Image& image) {
+    image.pixels = stbi_load(image.path.c_str(), &image.width, &image.height, NULL, 4);
+}
+
+void TextureAtlas::free_images() {
+    for (auto& image : m_images)
+        stbi_image_free(image->pixels);
+    m_images.clear();
+    m_decoded = 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "common.hpp"
+#include "asset_loader.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Part of an atlas holding one image
+struct AtlasRegion {
+    vec2 uv_min;
+    vec2 uv_max;
+    vec2 size; // of the image in pixels
+};
+
+// Several images packed in one texture
+//
+// Every skin of the turtles and fish is decoded once at startup and packed here, so switching
+// skins only changes the region an entity is drawn with: no decoding, no upload, and the sprite
+// batch draws every skin in the same call. The images are laid out in rows, tallest first, with
+// transparent padding so that linear filtering never reads a neighbour.
+// The images can be decoded on the workers of an AssetLoader, only the upload needs the GL thread.
+class TextureAtlas
+{
+public:
+    TextureAtlas();
+
+    // Starts decoding the images at paths on the loader
+    void load(AssetLoader& loader, const std::vector<const char*>& paths);
+
+    // Every image given to load() is decoded
+    bool is_decoded() const;
+
+    // Packs the decoded images and uploads them as one texture
+    bool upload();
+
+    // Decodes the images at paths and uploads them, on the calling thread
+    bool init(const std::vector<const char*>& paths);
+
+    void destroy();
+
+    // Region of the image loaded from path, nullptr if it isn't in the atlas
+    const AtlasRegion* find(const char* path) const;
+
+    const Texture& get_texture() const;
+
+private:
+    struct Image {
+        std::string path;
+        unsigned char* pixels;
+        int width;
+        int height;
+        int x; // where it goes in the atlas
+        int y;
+    };
+
+    // Decodes into image, can run on any thread
+    static void decode(Image& image);
+
+    // Frees the pixels of every image
+    void free_images();
+
+    // Images are allocated one by one, the workers decode into them while the vector grows
+    std::vector<std::unique_ptr<Image>> m_images;
+    size_t m_decoded;
+
+    std::vector<std::string> m_paths;
+    std::vector<AtlasRegion> m_regions;
+    Texture m_texture;
+};
@@ -2,313 +2,176 @@
 #include "turtle.hpp"
 
 #include <cmath>
-#include <iostream>
+#include <cstdio>
 
-Texture Turtle::turtle_texture;
-
-bool Turtle::init(bool m_mode3)
+bool Turtles::init(const TextureAtlas& atlas, bool mode3)
 {
+    m_texture = &atlas.get_texture();
+    m_store.clear();
+    m_path.clear();
+    m_mode2 = false;
 
-    if (m_mode3) {
-        if (!reskin())
-            return false;
-    } else {
-        if (!default_texture())
-            return false;
+    m_base_speed = 200.f;
+
+    m_default_skin = { atlas.find(textures_path("turtle.png")), { -0.5f, 0.5f } };
+    m_reskin = { atlas.find(textures_path("sasuke.png")), { -0.6f, 0.6f } };
+    if (m_default_skin.region == nullptr || m_reskin.region == nullptr) {
+        fprintf(stderr, "Turtle skins are missing from the atlas\n");
+        return false;
     }
 
-	// Loading shaders
-	if (!effect.load_from_file(shader_path("textured.vs.glsl"), shader_path("textured.fs.glsl")))
-		return false;
+    if (mode3)
+        reskin();
+    else
+        default_texture();
+    return true;
+}
 
-	motion.radians = 0.f;
-	motion.speed = 200.f;
+void Turtles::destroy()
+{
+    // The atlas owns the texture
+    m_store.clear();
+    m_path.clear();
+}
 
-	m_base_speed = motion.speed;
-	m_mode2 = false;
+EntityHandle Turtles::spawn(vec2 position)
+{
+    return m_store.add(position, m_base_speed);
+}
 
-	m_reskin_scale = { -0.6f, 0.6f };
-	m_default_scale = { -0.5f, 0.5f };
+void Turtles::remove(size_t index)
+{
+    m_store.remove(index);
+}
 
-	if (m_mode3)
-	    physics.scale = m_reskin_scale;
-	else
-	    physics.scale = m_default_scale;
+void Turtles::clear()
+{
+    m_store.clear();
+}
 
-	return true;
+void Turtles::truncate(size_t count)
+{
+    m_store.truncate(count);
 }
 
-// Releases all graphics resources
-void Turtle::destroy()
+size_t Turtles::size() const
 {
-	glDeleteBuffers(1, &mesh.vbo);
-	glDeleteBuffers(1, &mesh.ibo);
-	glDeleteBuffers(1, &mesh.vao);
+    return m_store.size();
+}
 
-	glDeleteShader(effect.vertex);
-	glDeleteShader(effect.fragment);
-	glDeleteShader(effect.program);
+void Turtles::save_positions()
+{
+    m_store.save_positions();
 }
 
-void Turtle::update(float ms)
+void Turtles::update(float ms)
 {
-	// Move fish along -X based on how much time has passed, this is to (partially) avoid
+	// Move turtles along -X based on how much time has passed, this is to (partially) avoid
 	// having entities move at different speed based on the machine.
     if (!m_mode2) {
-        float step = -1.f * motion.speed * (ms / 1000);
-        motion.position.x += step;
-    } else {
+        for (size_t i = 0; i < m_store.size(); ++i) {
+            float step = -1.f * m_store.speed[i] * (ms / 1000);
+            m_store.position_x[i] += step;
+        }
+        return;
+    }
 
-        float step = motion.speed * (ms / 1000);
+    size_t hunter;
+    if (find_hunter(hunter) && !m_path.empty()) {
+        vec2 position = m_store.get_position(hunter);
+        float step = m_store.speed[hunter] * (ms / 1000);
 
-        while (m_path.size() > 1 && len(sub(m_path.front(), motion.position)) < 10) {
+        while (m_path.size() > 1 && len(sub(m_path.front(), position)) < 10) {
             m_path.pop_front();
         }
 
-        vec2 direction = sub(m_path.front(), motion.position);
+        vec2 direction = sub(m_path.front(), position);
 
         if (direction.x != 0)
-            motion.position.x += step * (direction.x / abs(direction.x));
+            position.x += step * (direction.x / abs(direction.x));
 
         if (direction.y != 0)
-            motion.position.y += step * (direction.y / abs(direction.y));
-	}
-}
+            position.y += step * (direction.y / abs(direction.y));
 
-void Turtle::draw(const mat3& projection)
-{
-	// Transformation code, see Rendering and Transformation in the template specification for more info
-	// Incrementally updates transformation matrix, thus ORDER IS IMPORTANT
-	transform.begin();
-	transform.translate(motion.position);
-	transform.rotate(motion.radians);
-	transform.scale(physics.scale);
-	transform.end();
-
-	// Setting shaders
-	glUseProgram(effect.program);
-
-	// Enabling alpha channel for textures
-	glEnable(GL_BLEND); glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glDisable(GL_DEPTH_TEST);
-
-	// Getting uniform locations for glUniform* calls
-	GLint transform_uloc = glGetUniformLocation(effect.program, "transform");
-	GLint color_uloc = glGetUniformLocation(effect.program, "fcolor");
-	GLint projection_uloc = glGetUniformLocation(effect.program, "projection");
-
-	// Setting vertices and indices
-	glBindVertexArray(mesh.vao);
-	glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
-
-	// Input data location as in the vertex buffer
-	GLint in_position_loc = glGetAttribLocation(effect.program, "in_position");
-	GLint in_texcoord_loc = glGetAttribLocation(effect.program, "in_texcoord");
-	glEnableVertexAttribArray(in_position_loc);
-	glEnableVertexAttribArray(in_texcoord_loc);
-	glVertexAttribPointer(in_position_loc, 3, GL_FLOAT, GL_FALSE, sizeof(TexturedVertex), (void*)0);
-	glVertexAttribPointer(in_texcoord_loc, 2, GL_FLOAT, GL_FALSE, sizeof(TexturedVertex), (void*)sizeof(vec3));
-
-	// Enabling and binding texture to slot 0
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, turtle_texture.id);
-
-	// Setting uniform values to the currently bound program
-	glUniformMatrix3fv(transform_uloc, 1, GL_FALSE, (float*)&transform.out);
-	float color[] = { 1.f, 1.f, 1.f };
-	glUniform3fv(color_uloc, 1, color);
-	glUniformMatrix3fv(projection_uloc, 1, GL_FALSE, (float*)&projection);
-
-	// Drawing!
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, nullptr);
+        m_store.set_position(hunter, position);
+	}
 }
 
-vec2 Turtle::get_position()const
+void Turtles::draw(SpriteBatch& batch, float alpha) const
 {
-	return motion.position;
+    m_store.draw(batch, *m_texture, m_skin, alpha);
 }
 
-void Turtle::set_position(vec2 position)
+vec2 Turtles::get_position(size_t index) const
 {
-	motion.position = position;
+	return m_store.get_position(index);
 }
 
-vec2 Turtle::get_bounding_box() const
+vec2 Turtles::get_bounding_box() const
 {
-	// Returns the local bounding coordinates scaled by the current size of the turtle 
-	// fabs is to avoid negative scale due to the facing direction.
-	return { std::fabs(physics.scale.x) * turtle_texture.width, std::fabs(physics.scale.y) * turtle_texture.height };
+	// Returns the local bounding coordinates scaled by the current size of the turtles
+	return m_skin.get_size();
 }
 
-void Turtle::calculate_path(Salmon& salmon, std::vector<Fish>& fishes) {
-    std::list<Sector> closed_list;
-    std::list<Sector> open_list;
-
-    float step = 50.f;
-
-    vec2 position = {motion.position.x, motion.position.y};
-    vec2 goal = salmon.get_position();
-
-    Sector sector;
-    sector.init(position, goal, step, step);
-
-    open_list.push_front(sector);
-
-    float x_pos[3] = {-step, 0 , step};
-    float y_pos[9] = {step, step, step, 0, 0, 0, -step, -step, -step};
-
-    while (!open_list.empty()) {
-        Sector cur = open_list.front();
-        float best_f = cur.get_f(closed_list.back().get_position());
-        int index = 0;
-        int best_index = 0;
-
-        for (auto & it : open_list) {
-            if (it.get_f(closed_list.back().get_position()) < best_f) {
-                best_index = index;
-                best_f = it.get_f(closed_list.back().get_position());
-                cur = it;
-            }
-            index++;
-        }
-
-        auto it = open_list.begin();
-        advance(it, best_index);
-        open_list.erase(it);
-
-        if (cur.is_goal())
-            break;
-
-        for (int i = 0; i < 9; i++) {
-            float x = x_pos[i % 3] + cur.get_position().x;
-            float y = y_pos[i] + cur.get_position().y;
-
-            if (!(x == cur.get_position().x && y == cur.get_position().y)) {
-                Sector successor;
-                successor.init({x, y}, goal, step,
-                               abs(cur.get_position().x - x) < 0.001 || abs(cur.get_position().y - y) < 0.001 ?
-                               cur.get_move_cost() + step : cur.get_move_cost() + sqrt(pow(step, 2) + pow (step, 2)) - 1);
-
-                if (successor.valid_sector_for_turtle(fishes)) {
-                    if (!value_in_list(open_list, closed_list, successor) &&
-                        !value_in_list(closed_list, closed_list, successor))
-                            open_list.push_front(successor);
-                }
-            }
-        }
-
-        closed_list.push_back(cur);
+void Turtles::set_mode(bool mode2) {
+    m_mode2 = mode2;
+    m_hunter = EntityHandle();
+    if (!m_store.empty()) {
+        if (m_mode2)
+            m_hunter = m_store.handles.get_handle(0);
+        m_store.speed[0] = m_base_speed;
     }
-
-    Sector goal_sector;
-    goal_sector.init(goal, goal, step, 0);
-
-    closed_list.push_back(goal_sector);
     m_path.clear();
+}
 
-    for (auto & pos : closed_list) {
-        m_path.push_back(pos.get_position());
-    }
-
-    closed_list.clear();
-    open_list.clear();
+bool Turtles::has_hunter() const {
+    size_t hunter;
+    return find_hunter(hunter);
 }
 
-bool Turtle::value_in_list(std::list<Sector> open_list, std::list<Sector> closed_list, Sector value) {
-    for (auto & it : open_list) {
-        if (len(sub(it.get_position(), value.get_position())) < 0.01) {
-            if (it.get_f(closed_list.back().get_position()) <= value.get_f(closed_list.back().get_position()))
-                return true;
-        }
-    }
-    return false;
+bool Turtles::get_hunter_position(vec2& position) const {
+    size_t hunter;
+    if (!find_hunter(hunter))
+        return false;
+
+    position = m_store.get_position(hunter);
+    return true;
 }
 
-std::list<vec2> Turtle::get_path() {
-    return m_path;
+bool Turtles::find_hunter(size_t& index) const {
+    return m_mode2 && m_store.handles.find(m_hunter, index);
 }
 
-void Turtle::set_mode(bool mode) {
-    m_mode2 = mode;
-    motion.speed = m_base_speed;
-    m_path.clear();
+void Turtles::set_path(const std::list<vec2>& path) {
+    m_path = path;
 }
 
-void Turtle::update_speed(Salmon &salmon) {
+void Turtles::update_speed(vec2 salmon_position) {
+    size_t hunter;
+    if (!find_hunter(hunter))
+        return;
 
-    float dist = len(sub(motion.position, salmon.get_position()));
+    float dist = len(sub(m_store.get_position(hunter), salmon_position));
 
     if (dist > 800)
         return;
 
-    motion.speed = (pow(dist - 800, 2) / 1500.f) + m_base_speed;
-}
-
-bool Turtle::default_texture() {
-    if (!turtle_texture.load_from_file(textures_path("turtle.png"))) {
-        fprintf(stderr, "Failed to load fish texture!");
-        return false;
-    }
-
-    physics.scale = m_default_scale;
-    return load_texture();
+    m_store.speed[hunter] = (pow(dist - 800, 2) / 1500.f) + m_base_speed;
 }
 
-bool Turtle::reskin() {
-    if (!turtle_texture.load_from_file(textures_path("sasuke.png"))) {
-        fprintf(stderr, "Failed to load fish texture!");
-        return false;
-    }
-
-    physics.scale = m_reskin_scale;
-    return load_texture();
+void Turtles::default_texture() {
+    m_skin = m_default_skin;
 }
 
-
-bool Turtle::load_texture() {
-
-    // The position corresponds to the center of the texture
-    float wr = turtle_texture.width * 0.5f;
-    float hr = turtle_texture.height * 0.5f;
-
-    TexturedVertex vertices[4];
-    vertices[0].position = { -wr, +hr, -0.02f };
-    vertices[0].texcoord = { 0.f, 1.f };
-    vertices[1].position = { +wr, +hr, -0.02f };
-    vertices[1].texcoord = { 1.f, 1.f };
-    vertices[2].position = { +wr, -hr, -0.02f };
-    vertices[2].texcoord = { 1.f, 0.f };
-    vertices[3].position = { -wr, -hr, -0.02f };
-    vertices[3].texcoord = { 0.f, 0.f };
-
-    // Counterclockwise as it's the default opengl front winding direction
-    uint16_t indices[] = { 0, 3, 1, 1, 3, 2 };
-
-    // Clearing errors
-    gl_flush_errors();
-
-    // Vertex Buffer creation
-    glGenBuffers(1, &mesh.vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(TexturedVertex) * 4, vertices, GL_STATIC_DRAW);
-
-    // Index Buffer creation
-    glGenBuffers(1, &mesh.ibo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * 6, indices, GL_STATIC_DRAW);
-
-    // Vertex Array (Container for Vertex + Index buffer)
-    glGenVertexArrays(1, &mesh.vao);
-    return !gl_has_errors();
-
+void Turtles::reskin() {
+    m_skin = m_reskin;
 }
 
-void Turtle::turn_around() {
+void Turtles::turn_around(size_t index) {
 
     if (m_mode2)
         return;
 
-    if (motion.speed > 0)
-    motion.speed = -1.f * motion.speed;
-}
\ No newline at end of file
+    if (m_store.speed[index] > 0)
+        m_store.speed[index] = -1.f * m_store.speed[index];
+}
@@ -1,62 +1,91 @@
 #pragma once
 
 #include "common.hpp"
-#include "salmon.hpp"
-#include "sector.hpp"
-
-// Salmon enemy 
-class Turtle : public Entity
+#include "sprite_store.hpp"
+#include "sprite_batch.hpp"
+#include "texture_atlas.hpp"
+
+#include <list>
+
+// Salmon enemies, all the turtles of the level stored by component, see sprite_store.hpp
+//
+// Turtles swim to the left. In hunter mode (mode 2) only the first turtle is kept and it follows
+// the path planned towards the salmon instead, speeding up as it gets close. The hunter is held
+// by its handle, so it stays the hunter whatever happens to the other turtles.
+class Turtles
 {
-	// Shared between all turtles, no need to load one for each instance
-	static Texture turtle_texture;
-
 public:
-	// Creates all the associated render resources and default transform
-	bool init(bool m_mode3);
+	// Finds both skins in the atlas, starts with the reskinned one in mode 3
+	bool init(const TextureAtlas& atlas, bool mode3);
 
-	// Releases all the associated resources
+	// Removes the turtles
 	void destroy();
 
-	// Update turtle due to current
+	// Adds a turtle at position
+	EntityHandle spawn(vec2 position);
+
+	// Moves the last turtle into index
+	void remove(size_t index);
+
+	// Removes every turtle
+	void clear();
+
+	// Keeps the first count turtles
+	void truncate(size_t count);
+
+	size_t size() const;
+
+	// Where this update starts from, called before every update
+	void save_positions();
+
+	// Moves every turtle
 	// ms represents the number of milliseconds elapsed from the previous update() call
 	void update(float ms);
 
-	// Renders the salmon
-	// projection is the 2D orthographic projection matrix
-	void draw(const mat3& projection) override;
-
-	// Returns the current turtle position
-	vec2 get_position()const;
+	// Queues every turtle in the sprite batch, alpha of the way from the last update
+	void draw(SpriteBatch& batch, float alpha) const;
 
-	// Sets the new turtle position
-	void set_position(vec2 position);
+	vec2 get_position(size_t index) const;
 
-	// Returns the turtle' bounding box for collision detection, called by collides_with()
+	// Bounding box of every turtle for collision detection
 	vec2 get_bounding_box() const;
 
-    void calculate_path(Salmon& m_salmon, std::vector<Fish>& fishes);
+    // Hunter mode, the first turtle becomes the hunter and its speed and path are reset
+    void set_mode(bool mode2);
 
-    std::list<vec2> get_path();
+    // False outside of hunter mode or once the hunter is gone
+    bool has_hunter() const;
 
-    void set_mode(bool mode);
+    // Position of the hunter, false if there is none
+    bool get_hunter_position(vec2& position) const;
 
-    void update_speed(Salmon& salmon);
+    // Path of the hunter towards the salmon, planned by the PathPlanner
+    void set_path(const std::list<vec2>& path);
 
-    bool load_texture();
-    bool default_texture();
-    bool reskin();
+    // Speeds the hunter up as it closes in on the salmon
+    void update_speed(vec2 salmon_position);
 
-    void turn_around();
+    // Switches the skin of every turtle, the atlas already holds both
+    void default_texture();
+    void reskin();
+
+    // Sends a turtle back to the right, outside of hunter mode
+    void turn_around(size_t index);
 
 private:
-    bool value_in_list (std::list<Sector> open_list, std::list<Sector> closed_list, Sector value);
+    // Current index of the hunter, false outside of hunter mode or once the hunter is gone
+    bool find_hunter(size_t& index) const;
+
+    const Texture* m_texture;
+    SpriteSkin m_skin;
+    SpriteSkin m_default_skin;
+    SpriteSkin m_reskin;
+    SpriteStore m_store;
 
     std::list<vec2> m_path;
 
     bool m_mode2;
-
-    vec2 m_reskin_scale;
-    vec2 m_default_scale;
+    EntityHandle m_hunter;
 
     float m_base_speed;
-};
\ No newline at end of file
+};
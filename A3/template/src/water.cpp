@@ -3,6 +3,7 @@
 #include <iostream>
 #include <math.h>
 bool Water::init() {
+	m_time = 0;
 	m_dead_time = -1;
 
 	// Since we are not going to apply transformation to this screen geometry
@@ -39,13 +40,11 @@ bool Water::init() {
 void Water::destroy() {
 	glDeleteBuffers(1, &mesh.vbo);
 
-	glDeleteShader(effect.vertex);
-	glDeleteShader(effect.fragment);
-	glDeleteShader(effect.program);
+	effect.release();
 }
 
 void Water::set_salmon_dead() {
-	m_dead_time = glfwGetTime();
+	m_dead_time = m_time;
 }
 
 void Water::reset_salmon_dead_time() {
@@ -53,7 +52,11 @@ void Water::reset_salmon_dead_time() {
 }
 
 float Water::get_salmon_dead_time() const {
-	return glfwGetTime() - m_dead_time;
+	return m_time - m_dead_time;
+}
+
+void Water::update(float ms) {
+	m_time += ms / 1000;
 }
 
 void Water::draw(const mat3& projection) {
@@ -73,8 +76,8 @@ void Water::draw(const mat3& projection) {
     GLuint debugging_uloc = glGetUniformLocation(effect.program, "debugging");
 
     glUniform1i(screen_text_uloc, 0);
-	glUniform1f(time_uloc, (float)(glfwGetTime() * 10.0f));
-	glUniform1f(dead_timer_uloc, (m_dead_time > 0) ? (float)((glfwGetTime() - m_dead_time) * 10.0f) : -1);
+	glUniform1f(time_uloc, m_time * 10.0f);
+	glUniform1f(dead_timer_uloc, (m_dead_time > 0) ? (m_time - m_dead_time) * 10.0f : -1);
     glUniform1f(debugging_uloc, m_debugging);
 
 	// Draw the screen texture on the quad geometry
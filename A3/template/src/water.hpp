@@ -12,6 +12,9 @@ public:
 	// Releases all associated resources
 	void destroy();
 
+	// Advances the clock driving the waves and the death fade
+	void update(float ms);
+
 	// Renders the water
 	void draw(const mat3& projection)override;
 
@@ -24,6 +27,9 @@ public:
 	void set_debugging (bool debug_mode);
 
 private:
+	// Seconds of game time, the game may run faster or slower than the wall clock
+	float m_time;
+
 	// When salmon is alive, the time is set to -1
 	float m_dead_time;
 	bool m_debugging;
@@ -1,37 +1,54 @@
 // Header
 #include "world.hpp"
 
+#include "profiler.hpp"
+
 // stlib
 #include <string.h>
+#include <algorithm>
 #include <cassert>
 #include <sstream>
+#include <iomanip>
 
 #include <iostream>
+#include <thread>
 
 // Same as static in c, local to compilation unit
 namespace
 {
 	const size_t MAX_TURTLES = 15;
-	const size_t MAX_FISH = 5;
+	const size_t MAX_FISH = 25;
 	size_t TURTLE_DELAY_MS = 3000;
 	const size_t FISH_DELAY_MS = 2000;
+	const float NAV_CELL_SIZE = 16.f;
+	const float FISH_EXIT_X = -150.f;
+	const float BROADPHASE_CELL_SIZE = 64.f;
 
-	namespace
-	{
-		void glfw_err_cb(int error, const char* desc)
-		{
-			fprintf(stderr, "%d: %s", error, desc);
-		}
-	}
+	// Salmon momentum lost per second once the key is released
+	const float MOVE_TIMER_DECAY = 1.2f;
+
+	// Proxy types in the broadphase
+	enum { COLLIDER_SALMON, COLLIDER_TURTLE, COLLIDER_FISH, COLLIDER_PEBBLE };
+
+	// Written in the working directory when T is released
+	const char* TRACE_PATH = "salmon_trace.json";
+
+	// Render passes timed on the GPU
+	enum { GPU_PASS_ENTITIES, GPU_PASS_PEBBLES, GPU_PASS_DEBUG, GPU_PASS_WATER, GPU_PASS_COUNT };
+	const char* GPU_PASS_NAMES[GPU_PASS_COUNT] = { "entities", "pebbles", "debug", "water" };
+
+	// Workers decoding the skins and sounds, there are only a handful of files
+	const unsigned MAX_ASSET_THREADS = 4;
 }
 
 World::World() : 
 m_points(0),
 m_next_turtle_spawn(0.f),
-m_next_fish_spawn(0.f)
+m_next_fish_spawn(0.f),
+m_deterministic(false),
+m_tick(0),
+m_step_ms(0.f)
 {
-	// Seeding rng with random device
-	m_rng = std::default_random_engine(std::random_device()());
 }
 
 World::~World()
@@ -40,46 +57,26 @@ World::~World()
 }
 
 // World initialization
-bool World::init(vec2 screen)
+bool World::init(vec2 screen, Window& window, Audio& audio)
 {
-	//-------------------------------------------------------------------------
-	// GLFW / OGL Initialization
-	// Core Opengl 3.
-	glfwSetErrorCallback(glfw_err_cb);
-	if (!glfwInit())
-	{
-		fprintf(stderr, "Failed to initialize GLFW");
-		return false;
-	}
+	m_window = &window;
+	m_audio = &audio;
 
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, 1);
-#if __APPLE__
-	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#endif
-	glfwWindowHint(GLFW_RESIZABLE, 0);
-	m_window = glfwCreateWindow((int)screen.x, (int)screen.y, "Salmon Game Assignment", nullptr, nullptr);
-	if (m_window == nullptr)
-		return false;
+	m_startup = StartupTimer();
+	m_first_frame_drawn = false;
+	m_assets_loaded = false;
 
-	glfwMakeContextCurrent(m_window);
-	glfwSwapInterval(1); // vsync
+	// The skins are decoded while the window and the GL resources are created
+	m_assets.init(std::max(1u, std::min(MAX_ASSET_THREADS, std::thread::hardware_concurrency())));
+	m_sprite_atlas.load(m_assets, {textures_path("turtle.png"), textures_path("sasuke.png"),
+	                               textures_path("fish.png"), textures_path("ramen.png")});
 
-	// Load OpenGL function pointers
-	gl3w_init();
+	if (!m_window->init(screen))
+		return false;
 
-	// Setting callbacks to member functions (that's why the redirect is needed)
-	// Input is handled using GLFW, for more info see
-	// http://www.glfw.org/docs/latest/input_guide.html
-	glfwSetWindowUserPointer(m_window, this);
-	auto key_redirect = [](GLFWwindow* wnd, int _0, int _1, int _2, int _3) { ((World*)glfwGetWindowUserPointer(wnd))->on_key(wnd, _0, _1, _2, _3); };
-	auto cursor_pos_redirect = [](GLFWwindow* wnd, double _0, double _1) { ((World*)glfwGetWindowUserPointer(wnd))->on_mouse_move(wnd, _0, _1); };
-    auto mouse_button_redirect = [](GLFWwindow* wnd,int _0, int _1, int _2) { ((World*)glfwGetWindowUserPointer(wnd))->on_mouse_click(wnd, _0, _1, _2); };
-    glfwSetKeyCallback(m_window, key_redirect);
-	glfwSetCursorPosCallback(m_window, cursor_pos_redirect);
-    glfwSetMouseButtonCallback(m_window, mouse_button_redirect);
+	m_window->set_callbacks([this](int key, int action, int mod) { on_window_key(key, action, mod); },
+	                        [this](double xpos, double ypos) { on_mouse_move(xpos, ypos); },
+	                        [this](int key, int action, int mod) { on_window_mouse_click(key, action, mod); });
 
 	// Create a frame buffer
 	m_frame_buffer = 0;
@@ -89,28 +86,21 @@ bool World::init(vec2 screen)
 	// For some high DPI displays (ex. Retina Display on Macbooks)
 	// https://stackoverflow.com/questions/36672935/why-retina-screen-coordinate-value-is-twice-the-value-of-pixel-value
 	int fb_width, fb_height;
-	glfwGetFramebufferSize(m_window, &fb_width, &fb_height);
+	m_window->get_framebuffer_size(fb_width, fb_height);
 	m_screen_scale = static_cast<float>(fb_width) / screen.x;
 
 	// Initialize the screen texture
-	m_screen_tex.create_from_screen(m_window);
+	m_screen_tex.create_from_screen(fb_width, fb_height);
+	m_startup.mark("window");
 
 	//-------------------------------------------------------------------------
-	// Loading music and sounds
-	if (SDL_Init(SDL_INIT_AUDIO) < 0)
-	{
-		fprintf(stderr, "Failed to initialize SDL Audio");
+	// Loading music and sounds, nothing waits for them, they play once decoded
+	if (!m_audio->init())
 		return false;
-	}
 
-	if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) == -1)
-	{
-		fprintf(stderr, "Failed to open audio device");
-		return false;
-	}
-
-    if(!load_default_sounds())
-        return false;
+    m_audio->load(m_assets);
+    m_audio->set_theme(Audio::DEFAULT_THEME);
+    m_startup.mark("audio device");
 
 	m_current_speed = 0.25f;
 
@@ -139,7 +129,6 @@ bool World::init(vec2 screen)
     m_spawning_pebbles = false;
 
 	m_num_pebbles = {3, 5};
-    srand (time(NULL));
 
     m_gravity = 2;
 
@@ -150,15 +139,36 @@ bool World::init(vec2 screen)
     m_base_turtle_delay = TURTLE_DELAY_MS;
     m_mode3_turtle_delay = (int) (0.5 * m_base_turtle_delay);
 
-    return m_salmon.init({m_level_bounds_padding, m_level_bounds.x - m_level_bounds_padding},
-            {m_level_bounds_padding , m_level_bounds.y - m_level_bounds_padding}) &&
-           m_water.init() &&
-           m_pebbles_emitter.init(m_level_bounds, m_current_speed) &&
-           m_debug_path.init(screen) &&
-           m_debug_boundaries.init({m_level_bounds_padding, m_level_bounds.x - m_level_bounds_padding},
-                                 {m_level_bounds_padding , m_level_bounds.y - m_level_bounds_padding}, m_level_bounds) &&
-           m_debug_collider.init(m_salmon.get_x_bounds(), m_salmon.get_y_bounds(), m_level_bounds, m_salmon.get_scale()) &&
-           m_debug_collision.init(m_salmon);
+    if (!m_salmon.init(m_resources, {m_level_bounds_padding, m_level_bounds.x - m_level_bounds_padding},
+                       {m_level_bounds_padding , m_level_bounds.y - m_level_bounds_padding}) ||
+        !m_water.init() ||
+        !m_sprite_batch.init())
+        return false;
+    m_startup.mark("meshes and shaders");
+
+    // The first frame needs the skins, the workers have had the time above to decode them
+    m_assets.wait([this] { return m_sprite_atlas.is_decoded(); });
+    if (!m_sprite_atlas.upload())
+        return false;
+    m_startup.mark("textures");
+
+    bool initialized =
+        m_turtles.init(m_sprite_atlas, m_mode3) &&
+        m_fish.init(m_sprite_atlas, m_mode3) &&
+        m_gpu_timer.init(GPU_PASS_COUNT) &&
+        m_pebbles_emitter.init(m_level_bounds, m_current_speed, m_random) &&
+        m_nav_grid.init(m_level_bounds, NAV_CELL_SIZE) &&
+        m_path_planner.init(m_nav_grid, FISH_EXIT_X) &&
+        m_broadphase.init(BROADPHASE_CELL_SIZE) &&
+        m_debug_path.init(screen) &&
+        m_debug_boundaries.init({m_level_bounds_padding, m_level_bounds.x - m_level_bounds_padding},
+                              {m_level_bounds_padding , m_level_bounds.y - m_level_bounds_padding}, m_level_bounds) &&
+        m_debug_collider.init(m_salmon.get_x_bounds(), m_salmon.get_y_bounds(), m_level_bounds, m_salmon.get_scale()) &&
+        m_debug_collision.init(m_salmon);
+    m_startup.mark("world");
+    m_startup.report();
+
+    return initialized;
 }
 
 // Releases all the associated resources
@@ -166,28 +176,50 @@ void World::destroy()
 {
 	glDeleteFramebuffers(1, &m_frame_buffer);
 
-	if (m_background_music != nullptr)
-		Mix_FreeMusic(m_background_music);
-	if (m_salmon_dead_sound != nullptr)
-		Mix_FreeChunk(m_salmon_dead_sound);
-	if (m_salmon_eat_sound != nullptr)
-		Mix_FreeChunk(m_salmon_eat_sound);
-
-	Mix_CloseAudio();
+	// Before anything the loader still decodes into
+	m_assets.destroy();
+	m_audio->destroy();
 
+	m_path_planner.destroy();
+	m_sprite_batch.destroy();
+	m_gpu_timer.destroy();
 	m_salmon.destroy();
 	m_pebbles_emitter.destroy();
-	for (auto& turtle : m_turtles)
-		turtle.destroy();
-	for (auto& fish : m_fish)
-		fish.destroy();
-	m_turtles.clear();
-	m_fish.clear();
-	glfwDestroyWindow(m_window);
+	m_turtles.destroy();
+	m_fish.destroy();
+	m_sprite_atlas.destroy();
+	m_resources.destroy();
+	m_recorder.destroy(m_tick);
+	m_player.destroy();
+	m_window->destroy();
 }
 
 // Update our game world
 bool World::update(float elapsed_ms) {
+    PROFILE_ZONE("update");
+
+    // Input and steps are applied before the update they were recorded for
+    if (m_player.is_playing()) {
+        InputEvent event;
+        while (m_player.next(m_tick, event)) {
+            if (event.type == InputEvent::KEY)
+                on_key(event.code, event.action, event.mod);
+            else if (event.type == InputEvent::MOUSE_BUTTON)
+                on_mouse_click(event.code, event.action, event.mod);
+            else
+                m_step_ms = event.ms;
+        }
+        elapsed_ms = m_step_ms;
+    } else if (m_recorder.is_recording() && elapsed_ms != m_step_ms) {
+        m_recorder.record({m_tick, InputEvent::STEP, 0, 0, 0, elapsed_ms});
+        m_step_ms = elapsed_ms;
+    }
+    ++m_tick;
+
+    // Where this update starts from, draw() interpolates from there
+    m_salmon.save_motion();
+    m_turtles.save_positions();
+    m_fish.save_positions();
 
     if (m_mode3 && !m_can_shoot) {
         m_shoot_pebble_timer += elapsed_ms;
@@ -218,38 +250,49 @@ bool World::update(float elapsed_ms) {
         m_frame_count++;
 
         int w, h;
-        glfwGetFramebufferSize(m_window, &w, &h);
+        m_window->get_framebuffer_size(w, h);
         vec2 screen = {(float) w / m_screen_scale, (float) h / m_screen_scale};
 
-        // Checking Salmon - Turtle collisions
-        for (const auto &turtle : m_turtles) {
-            if (m_salmon.collides_with(turtle)) {
-                if (m_salmon.is_alive()) {
-                    Mix_PlayChannel(-1, m_salmon_dead_sound, 0);
-                    m_water.set_salmon_dead();
+        ProfileZone collisions_zone("collisions");
+
+        // Pebbles only push each other, they are settled before the broadphase looks at them
+        m_pebbles_emitter.collides_with_pebble();
+
+        // Only the pairs found by the broadphase go through the collision tests below
+        update_broadphase();
+        m_broadphase.find_pairs(m_collision_pairs);
+
+        // Checking Salmon - Turtle and Salmon - Fish collisions, pairs come sorted so all the
+        // turtles are checked before the fish
+        m_eaten_fish.assign(m_fish.size(), false);
+        for (auto &pair : m_collision_pairs) {
+            if (pair.a.type != COLLIDER_SALMON)
+                continue;
+
+            if (pair.b.type == COLLIDER_TURTLE) {
+                if (m_salmon.collides_with_box(m_turtles.get_position(pair.b.index), m_turtles.get_bounding_box())) {
+                    if (m_salmon.is_alive()) {
+                        m_audio->play_salmon_dead();
+                        m_water.set_salmon_dead();
+                    }
+                    m_salmon.kill();
+                }
+            } else if (pair.b.type == COLLIDER_FISH) {
+                if (m_salmon.is_alive() &&
+                    m_salmon.collides_with_box(m_fish.get_position(pair.b.index), m_fish.get_bounding_box())) {
+                    m_eaten_fish[pair.b.index] = true;
+                    m_salmon.light_up();
+                    m_audio->play_salmon_eat();
+                    ++m_points;
                 }
-                m_salmon.kill();
-                break;
             }
         }
 
-        // Checking Salmon - Fish collisions
-        auto fish_it = m_fish.begin();
-        while (fish_it != m_fish.end()) {
-            if (m_salmon.is_alive() && m_salmon.collides_with(*fish_it)) {
-                fish_it = m_fish.erase(fish_it);
-                m_salmon.light_up();
-                Mix_PlayChannel(-1, m_salmon_eat_sound, 0);
-                ++m_points;
-            } else
-                ++fish_it;
-        }
-
         // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
         // SALMON MOMENTUM
         // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
         if (m_mode1 && m_key_up) {
-            m_move_timer -= 0.02f;
+            m_move_timer -= MOVE_TIMER_DECAY * (elapsed_ms / 1000);
             if (m_move_timer < 0.f)
                 m_move_timer = 0.f;
 
@@ -280,31 +323,65 @@ bool World::update(float elapsed_ms) {
         // HANDLE PEBBLE COLLISIONS HERE
         // DON'T WORRY ABOUT THIS UNTIL ASSIGNMENT 3
         // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
-        m_pebbles_emitter.collides_with_pebble();
-        for (auto &turtle : m_turtles) {
-            m_pebbles_emitter.collides_with(turtle);
+        for (auto &pair : m_collision_pairs) {
+            if (pair.b.type != COLLIDER_PEBBLE)
+                continue;
+
+            if (pair.a.type == COLLIDER_TURTLE)
+                m_pebbles_emitter.collides_with(pair.b.index, m_turtles, pair.a.index);
+            else if (pair.a.type == COLLIDER_FISH && !m_eaten_fish[pair.a.index])
+                m_pebbles_emitter.collides_with(pair.b.index, m_fish, pair.a.index);
+        }
+        for (auto &pair : m_collision_pairs) {
+            if (pair.a.type == COLLIDER_SALMON && pair.b.type == COLLIDER_PEBBLE)
+                m_pebbles_emitter.collides_with(pair.b.index, m_salmon);
         }
-        for (auto &fish : m_fish) {
-            m_pebbles_emitter.collides_with(fish);
+
+        // Removing the fish eaten by the salmon, from the back so that the fish moved into a
+        // removed slot was already looked at
+        for (size_t i = m_fish.size(); i-- > 0;) {
+            if (m_eaten_fish[i])
+                m_fish.remove(i);
         }
-        m_pebbles_emitter.collides_with(m_salmon);
+        collisions_zone.end();
 
         // Updating all entities, making the turtle and fish
         // faster based on current.
-        // In a pure ECS engine we would classify entities by their bitmap tags during the update loop
-        // rather than by their class.
+        // The turtles and fish are stored by component, each update below is one loop over their
+        // arrays, see sprite_store.hpp
+        ProfileZone entities_zone("entities");
         m_salmon.update(elapsed_ms);
         m_debug_collider.set_salmon_position(m_salmon.get_position());
+        m_nav_grid.set_salmon(m_salmon);
+
+        // Picks up the paths planned since the last frame, always the ones posted by the last
+        // frame when the game has to play out the same every run
+        ProfileZone planner_wait_zone("pathfinding wait");
+        if (m_deterministic)
+            m_path_planner.wait();
+        planner_wait_zone.end();
+        if (m_path_planner.poll()) {
+            const PathPlanner::Result& plan = m_path_planner.get_result();
+
+            m_debug_path.clear_paths();
+            for (auto &fish_path : plan.fish_paths)
+                m_debug_path.add_to_path(fish_path);
+
+            if (plan.has_turtle && m_turtles.has_hunter())
+                m_turtles.set_path(plan.turtle_path);
+            m_debug_path.add_to_path(plan.turtle_path);
+        }
 
-        if (m_mode2 && !m_turtles.empty() && m_salmon.is_alive())
-            m_turtles[0].update_speed(m_salmon);
+        if (m_mode2 && m_salmon.is_alive())
+            m_turtles.update_speed(m_salmon.get_position());
 
-        for (auto &turtle : m_turtles)
-            turtle.update(elapsed_ms * m_current_speed);
-        for (auto &fish : m_fish)
-            fish.update(elapsed_ms * m_current_speed);
+        m_turtles.update(elapsed_ms * m_current_speed);
+        m_fish.update(elapsed_ms * m_current_speed, m_path_planner.get_result().flow_field);
+        entities_zone.end();
 
+        ProfileZone pebbles_zone("pebbles");
         m_pebbles_emitter.update(elapsed_ms, m_salmon);
+        m_water.update(elapsed_ms);
 
 
         // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
@@ -317,7 +394,7 @@ bool World::update(float elapsed_ms) {
             }
 
             if (m_pebble_group_timer > m_pebble_group_frequency && m_salmon.is_alive()) {
-                m_pebbles_to_spawn = rand() % (int) m_num_pebbles.y + m_num_pebbles.x;
+                m_pebbles_to_spawn = m_random.integer((int) m_num_pebbles.y) + m_num_pebbles.x;
                 m_spawning_pebbles = true;
                 m_pebble_group_timer = 0;
             }
@@ -337,80 +414,66 @@ bool World::update(float elapsed_ms) {
                 }
             }
         }
+        pebbles_zone.end();
+
+        ProfileZone spawning_zone("spawning");
 
         // Removing out of screen turtles
         if (!m_mode2) {
-            auto turtle_it = m_turtles.begin();
-            while (turtle_it != m_turtles.end()) {
-                float w = turtle_it->get_bounding_box().x / 2;
-                if (turtle_it->get_position().x + w < 0.f || turtle_it->get_position().x - 200 > m_level_bounds.x) {
-                    turtle_it = m_turtles.erase(turtle_it);
-                    continue;
-                }
-
-                ++turtle_it;
+            float w = m_turtles.get_bounding_box().x / 2;
+            for (size_t i = m_turtles.size(); i-- > 0;) {
+                vec2 position = m_turtles.get_position(i);
+                if (position.x + w < 0.f || position.x - 200 > m_level_bounds.x)
+                    m_turtles.remove(i);
             }
         }
 
         // Removing out of screen fish
-        fish_it = m_fish.begin();
-        while (fish_it != m_fish.end()) {
-            float w = fish_it->get_bounding_box().x / 2;
-            if (fish_it->get_position().x + w < 0.f) {
-                fish_it = m_fish.erase(fish_it);
-                continue;
-            }
-
-            ++fish_it;
+        float fish_w = m_fish.get_bounding_box().x / 2;
+        for (size_t i = m_fish.size(); i-- > 0;) {
+            if (m_fish.get_position(i).x + fish_w < 0.f)
+                m_fish.remove(i);
         }
 
         // Spawning new turtles
         if (!m_mode2) {
             m_next_turtle_spawn -= elapsed_ms * m_current_speed;
             if (m_turtles.size() <= MAX_TURTLES && m_next_turtle_spawn < 0.f) {
-                if (!spawn_turtle())
-                    return false;
-
-                Turtle &new_turtle = m_turtles.back();
-
                 // Setting random initial position
-                new_turtle.set_position({screen.x + 150, 50 + m_dist(m_rng) * (screen.y - 100)});
+                m_turtles.spawn({screen.x + 150, 50 + m_random.uniform() * (screen.y - 100)});
 
                 // Next spawn
-                m_next_turtle_spawn = (TURTLE_DELAY_MS / 2) + m_dist(m_rng) * (TURTLE_DELAY_MS / 2);
+                m_next_turtle_spawn = (TURTLE_DELAY_MS / 2) + m_random.uniform() * (TURTLE_DELAY_MS / 2);
             }
         }
 
         // Spawning new fish
         m_next_fish_spawn -= elapsed_ms * m_current_speed;
         if (m_fish.size() <= MAX_FISH && m_next_fish_spawn < 0.f) {
-            if (!spawn_fish())
-                return false;
-            Fish &new_fish = m_fish.back();
-            new_fish.set_position({screen.x + 150, 50 + m_dist(m_rng) * (screen.y - 100)});
-
-            if (m_salmon.is_alive()) {
-                new_fish.calculate_path(m_salmon);
-                m_debug_path.add_to_path(new_fish.get_path());
-            }
+            m_fish.spawn({screen.x + 150, 50 + m_random.uniform() * (screen.y - 100)});
 
-            m_next_fish_spawn = (FISH_DELAY_MS / 2) + m_dist(m_rng) * (FISH_DELAY_MS / 2);
+            m_next_fish_spawn = (FISH_DELAY_MS / 2) + m_random.uniform() * (FISH_DELAY_MS / 2);
         }
-
-        if (m_frame_count > m_frame_skip && m_salmon.is_alive()) {
-            m_debug_path.clear_paths();
-
-            for (auto &fish : m_fish) {
-                fish.calculate_path(m_salmon);
-                m_debug_path.add_to_path(fish.get_path());
-            }
-
-            if (m_mode2 && !m_turtles.empty()) {
-                m_turtles[0].calculate_path(m_salmon, m_fish);
-                m_debug_path.add_to_path(m_turtles[0].get_path());
-            }
-
-            m_frame_count = 0;
+        spawning_zone.end();
+
+        // The flow field is only right for the grid it was built from, so the fish get a new one
+        // every tick the grid changes. Only the turtle A* waits for m_frame_skip ticks.
+        bool plan_turtle = m_frame_count > m_frame_skip;
+        if ((plan_turtle || m_nav_grid.get_version() != m_planned_nav_version) && m_salmon.is_alive()) {
+            PROFILE_ZONE("pathfinding snapshot");
+            PathPlanner::Snapshot snapshot;
+            snapshot.nav_grid = m_nav_grid;
+            snapshot.salmon_position = m_salmon.get_position();
+            for (size_t i = 0; i < m_fish.size(); ++i)
+                snapshot.fish_positions.push_back(m_fish.get_position(i));
+            snapshot.has_turtle = m_turtles.get_hunter_position(snapshot.turtle_position);
+            snapshot.plan_turtle = plan_turtle;
+
+            m_path_planner.post(snapshot);
+            m_planned_nav_version = m_nav_grid.get_version();
+
+            if (plan_turtle)
+                m_frame_count = 0;
         }
 
         // If salmon is dead, restart the game after the fading animation
@@ -425,19 +488,32 @@ bool World::update(float elapsed_ms) {
 
 // Render our game world
 // http://www.opengl-tutorial.org/intermediate-tutorials/tutorial-14-render-to-texture/
-void World::draw()
+void World::draw(float alpha)
 {
+	PROFILE_ZONE("draw");
+
+	// Assets decoded in the background are finished here, on the thread with the GL context
+	if (m_assets.poll() > 0 && m_assets.get_pending() == 0 && !m_assets_loaded) {
+		m_assets_loaded = true;
+		fprintf(stderr, "Background assets loaded after %.1f ms\n", m_startup.get_elapsed_ms());
+	}
+
 	// Clearing error buffer
 	gl_flush_errors();
 
+	// Picking up the GPU times of a few frames ago
+	m_gpu_timer.begin_frame();
+
 	// Getting size of window
 	int w, h;
-	glfwGetFramebufferSize(m_window, &w, &h);
+	m_window->get_framebuffer_size(w, h);
 
-	// Updating window title with points
+	// Updating window title with points and the GPU milliseconds of each pass
 	std::stringstream title_ss;
-	title_ss << "Points: " << m_points;
-	glfwSetWindowTitle(m_window, title_ss.str().c_str());
+	title_ss << "Points: " << m_points << " | GPU ms" << std::fixed << std::setprecision(2);
+	for (int pass = 0; pass < GPU_PASS_COUNT; ++pass)
+		title_ss << (pass == 0 ? " " : ", ") << GPU_PASS_NAMES[pass] << " " << m_gpu_timer.get_ms(pass);
+	m_window->set_title(title_ss.str().c_str());
 
 	/////////////////////////////////////
 	// First render to the custom framebuffer
@@ -472,23 +548,37 @@ void World::draw()
 	// The shaders coloured.vs.glsl and coloured.fs.glsl should be helpful.
 	// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 
-	// Drawing entities
-	for (auto& turtle : m_turtles)
-		turtle.draw(projection_2D);
-	for (auto& fish : m_fish)
-		fish.draw(projection_2D);
+	// Drawing entities, between the last two updates
+	ProfileZone scene_zone("scene pass");
+	m_salmon.set_draw_alpha(alpha);
+	m_pebbles_emitter.set_draw_alpha(alpha);
+	m_turtles.draw(m_sprite_batch, alpha);
+	m_fish.draw(m_sprite_batch, alpha);
+	m_gpu_timer.begin(GPU_PASS_ENTITIES);
+	m_sprite_batch.draw(projection_2D);
+	m_gpu_timer.end();
+	m_gpu_timer.begin(GPU_PASS_PEBBLES);
     m_pebbles_emitter.draw(projection_2D);
+	m_gpu_timer.end();
+	m_gpu_timer.begin(GPU_PASS_ENTITIES);
     m_salmon.draw(projection_2D);
+	m_gpu_timer.end();
+	scene_zone.end();
 
 	if (m_debugging) {
+        PROFILE_ZONE("debug pass");
+        m_gpu_timer.begin(GPU_PASS_DEBUG);
         m_debug_boundaries.draw(projection_2D);
         m_debug_collider.draw(projection_2D);
         m_debug_path.draw(projection_2D);
         m_debug_collision.draw(projection_2D);
+        m_gpu_timer.end();
     }
 
 	/////////////////////
 	// Truely render to the screen
+	ProfileZone water_zone("water pass");
+	m_gpu_timer.begin(GPU_PASS_WATER);
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// Clearing backbuffer
@@ -503,46 +593,89 @@ void World::draw()
 	glBindTexture(GL_TEXTURE_2D, m_screen_tex.id);
 
     m_water.draw(projection_2D);
+	m_gpu_timer.end();
+	water_zone.end();
 
 	//////////////////
 	// Presenting
-	glfwSwapBuffers(m_window);
+	PROFILE_ZONE("present");
+	m_window->swap_buffers();
+
+	if (!m_first_frame_drawn) {
+		m_first_frame_drawn = true;
+		fprintf(stderr, "First frame after %.1f ms\n", m_startup.get_elapsed_ms());
+	}
 }
 
 // Should the game be over ?
 bool World::is_over() const
 {
-	return glfwWindowShouldClose(m_window);
+	return m_window->should_close() || m_player.is_finished(m_tick);
 }
 
-// Creates a new turtle and if successfull adds it to the list of turtles
-bool World::spawn_turtle()
+unsigned int World::get_points() const
 {
-	Turtle turtle;
-	if (turtle.init(m_mode3))
-	{
-		m_turtles.emplace_back(turtle);
-		return true;
-	}
-	fprintf(stderr, "Failed to spawn turtle");
-	return false;
+	return m_points;
 }
 
-// Creates a new fish and if successfull adds it to the list of fish
-bool World::spawn_fish()
+void World::seed(uint32_t seed)
 {
-	Fish fish;
-	if (fish.init(m_mode3))
-	{
-		m_fish.emplace_back(fish);
-		return true;
-	}
-	fprintf(stderr, "Failed to spawn fish");
-	return false;
+	m_random.seed(seed);
+	m_deterministic = true;
+}
+
+bool World::record(const char* path)
+{
+	seed(m_random.get_seed());
+	m_step_ms = 0.f;
+	return m_recorder.init(path, m_random.get_seed());
+}
+
+bool World::replay(const char* path)
+{
+	if (!m_player.init(path))
+		return false;
+
+	seed(m_player.get_seed());
+	m_step_ms = 0.f;
+	return true;
+}
+
+void World::update_broadphase() {
+    m_broadphase.clear();
+
+    // Bounding circle of the salmon, it does not change when it turns
+    m_salmon.calculate_corners();
+    vec2 salmon_pos = m_salmon.get_position();
+    float salmon_r = std::max(std::max(len(sub(m_salmon.get_top_left_corner(), salmon_pos)),
+                                       len(sub(m_salmon.get_top_right_corner(), salmon_pos))),
+                              std::max(len(sub(m_salmon.get_bottom_left_corner(), salmon_pos)),
+                                       len(sub(m_salmon.get_bottom_right_corner(), salmon_pos))));
+    m_broadphase.insert(COLLIDER_SALMON, 0, sub(salmon_pos, {salmon_r, salmon_r}), add(salmon_pos, {salmon_r, salmon_r}));
+
+    // Turtles and fish collide within 0.6 of the largest side of their bounding box
+    vec2 turtle_box = m_turtles.get_bounding_box();
+    float turtle_r = std::max(turtle_box.x, turtle_box.y) * 0.6f;
+    for (size_t i = 0; i < m_turtles.size(); ++i) {
+        vec2 pos = m_turtles.get_position(i);
+        m_broadphase.insert(COLLIDER_TURTLE, (int) i, sub(pos, {turtle_r, turtle_r}), add(pos, {turtle_r, turtle_r}));
+    }
+    vec2 fish_box = m_fish.get_bounding_box();
+    float fish_r = std::max(fish_box.x, fish_box.y) * 0.6f;
+    for (size_t i = 0; i < m_fish.size(); ++i) {
+        vec2 pos = m_fish.get_position(i);
+        m_broadphase.insert(COLLIDER_FISH, (int) i, sub(pos, {fish_r, fish_r}), add(pos, {fish_r, fish_r}));
+    }
+
+    for (size_t i = 0; i < m_pebbles_emitter.get_pebble_count(); ++i) {
+        vec2 min, max;
+        m_pebbles_emitter.get_pebble_bounds(i, min, max);
+        m_broadphase.insert(COLLIDER_PEBBLE, (int) i, min, max);
+    }
 }
 
 // On key callback
-void World::on_key(GLFWwindow*, int key, int, int action, int mod)
+void World::on_key(int key, int action, int mod)
 {
 	// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 	// HANDLE SALMON MOVEMENT HERE
@@ -616,17 +749,14 @@ void World::on_key(GLFWwindow*, int key, int, int action, int mod)
     if (action == GLFW_RELEASE && key == GLFW_KEY_K && !m_mode3) {
         m_mode2 = true;
 
-        m_turtles.resize(1);
-
-        if (!m_turtles.empty())
-            m_turtles[0].set_mode(m_mode2);
+        m_turtles.truncate(1);
+        m_turtles.set_mode(m_mode2);
 
     }
     if (action == GLFW_RELEASE && key == GLFW_KEY_L) {
         m_mode2 = false;
 
-        if (!m_turtles.empty())
-            m_turtles[0].set_mode(m_mode2);
+        m_turtles.set_mode(m_mode2);
     }
 
     if (action == GLFW_PRESS && key == GLFW_KEY_B) {
@@ -646,30 +776,29 @@ void World::on_key(GLFWwindow*, int key, int, int action, int mod)
 
         m_pebbles_emitter.set_mode3(m_mode3);
         TURTLE_DELAY_MS = m_mode3_turtle_delay;
-        load_dope_sounds();
+        m_audio->set_theme(Audio::DOPE_THEME);
 
-        for (auto &fish : m_fish)
-            fish.reskin();
-        for (auto &turtle : m_turtles)
-            turtle.reskin();
+        m_fish.reskin();
+        m_turtles.reskin();
 
-        if (!m_turtles.empty())
-            m_turtles[0].set_mode(m_mode2);
+        m_turtles.set_mode(m_mode2);
     }
 
     if (action == GLFW_RELEASE && key == GLFW_KEY_I) {
         m_mode3 = false;
         m_pebbles_emitter.set_mode3(m_mode3);
         TURTLE_DELAY_MS = m_base_turtle_delay;
-        load_default_sounds();
+        m_audio->set_theme(Audio::DEFAULT_THEME);
 
-        for (auto &fish : m_fish)
-            fish.default_texture();
-        for (auto &turtle : m_turtles)
-            turtle.default_texture();
+        m_fish.default_texture();
+        m_turtles.default_texture();
     }
 
 
+	// Saving the last frames of profiling zones, see profiler.hpp
+	if (action == GLFW_RELEASE && key == GLFW_KEY_T)
+		Profiler::save_trace(TRACE_PATH);
+
 	// Resetting game
 	if (action == GLFW_RELEASE && key == GLFW_KEY_R) {
         reset_world();
@@ -701,7 +830,7 @@ void World::on_key(GLFWwindow*, int key, int, int action, int mod)
 	m_current_speed = fmax(0.f, m_current_speed);
 }
 
-void World::on_mouse_move(GLFWwindow* window, double xpos, double ypos)
+void World::on_mouse_move(double xpos, double ypos)
 {
 	// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 	// HANDLE SALMON ROTATION HERE
@@ -721,25 +850,48 @@ void World::on_mouse_move(GLFWwindow* window, double xpos, double ypos)
 //    }
 }
 
-void World::on_mouse_click(GLFWwindow* window, int key, int action, int mod) {
-    double xposition, yposition;
-    glfwGetCursorPos(window, &xposition, &yposition);
+void World::on_mouse_click(int key, int action, int mod) {
     if (key == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS && m_mode3 && m_can_shoot) {
         m_can_shoot = false;
         m_pebbles_emitter.spawn_pebble(m_salmon.get_mouth_pos(), m_salmon.get_rotation(), m_gravity);
     }
 }
 
+void World::on_window_key(int key, int action, int mod) {
+    if (m_player.is_playing())
+        return;
+
+    if (m_recorder.is_recording())
+        m_recorder.record({m_tick, InputEvent::KEY, key, action, mod, 0.f});
+    on_key(key, action, mod);
+}
+
+void World::on_window_mouse_click(int key, int action, int mod) {
+    if (m_player.is_playing())
+        return;
+
+    if (m_recorder.is_recording())
+        m_recorder.record({m_tick, InputEvent::MOUSE_BUTTON, key, action, mod, 0.f});
+    on_mouse_click(key, action, mod);
+}
+
 void World::reset_world() {
-    int w, h;
-    glfwGetWindowSize(m_window, &w, &h);
     m_salmon.destroy();
-    m_salmon.init({m_level_bounds_padding, m_level_bounds.x - m_level_bounds_padding},
+    m_salmon.init(m_resources, {m_level_bounds_padding, m_level_bounds.x - m_level_bounds_padding},
                   {m_level_bounds_padding , m_level_bounds.y - m_level_bounds_padding});
     m_pebbles_emitter.destroy();
-    m_pebbles_emitter.init(m_level_bounds, m_current_speed);
+    m_pebbles_emitter.init(m_level_bounds, m_current_speed, m_random);
+    m_nav_grid.destroy();
+    m_nav_grid.init(m_level_bounds, NAV_CELL_SIZE);
+    m_path_planner.destroy();
+    m_path_planner.init(m_nav_grid, FISH_EXIT_X);
+    m_planned_nav_version = m_nav_grid.get_version();
     m_turtles.clear();
     m_fish.clear();
+    m_turtles.default_texture();
+    m_fish.default_texture();
+    m_turtles.set_mode(false);
+    m_resources.purge();
     m_water.reset_salmon_dead_time();
     m_current_speed = 0.25f;
     m_points = 0;
@@ -765,45 +917,5 @@ void World::reset_world() {
 
     m_water.set_debugging(m_debugging);
 
-    load_default_sounds();
-}
-
-bool World::load_default_sounds() {
-    m_background_music = Mix_LoadMUS(audio_path("music.wav"));
-    m_salmon_dead_sound = Mix_LoadWAV(audio_path("salmon_dead.wav"));
-    m_salmon_eat_sound = Mix_LoadWAV(audio_path("salmon_eat.wav"));
-
-    if (m_background_music == nullptr || m_salmon_dead_sound == nullptr || m_salmon_eat_sound == nullptr) {
-        fprintf(stderr, "Failed to load sounds\n %s\n %s\n %s\n make sure the data directory is present",
-                audio_path("music.wav"),
-                audio_path("dead.wav"),
-                audio_path("eat.wav"));
-        return false;
-    }
-
-    Mix_PlayMusic(m_background_music, -1);
-    fprintf(stderr, "Loaded music\n");
-
-    return true;
+    m_audio->set_theme(Audio::DEFAULT_THEME);
 }
-
-bool World::load_dope_sounds() {
-    m_background_music = Mix_LoadMUS(audio_path("music2.wav"));
-    m_salmon_dead_sound = Mix_LoadWAV(audio_path("dead.wav"));
-    m_salmon_eat_sound = Mix_LoadWAV(audio_path("eat.wav"));
-
-    if (m_background_music == nullptr || m_salmon_dead_sound == nullptr || m_salmon_eat_sound == nullptr) {
-        fprintf(stderr, "Failed to load sounds\n %s\n %s\n %s\n make sure the data directory is present",
-                audio_path("music2.wav"),
-                audio_path("dead.wav"),
-                audio_path("eat.wav"));
-        return false;
-    }
-
-    Mix_PlayMusic(m_background_music, -1);
-    fprintf(stderr, "Loaded dope music\n");
-
-    return true;
-}
-
-
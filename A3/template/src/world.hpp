@@ -2,11 +2,23 @@
 
 // internal
 #include "common.hpp"
+#include "platform.hpp"
 #include "salmon.hpp"
 #include "turtle.hpp"
 #include "fish.hpp"
 #include "water.hpp"
 #include "pebbles.hpp"
+#include "nav_grid.hpp"
+#include "path_planner.hpp"
+#include "spatial_hash.hpp"
+#include "sprite_batch.hpp"
+#include "texture_atlas.hpp"
+#include "asset_loader.hpp"
+#include "resource_cache.hpp"
+#include "gpu_timer.hpp"
+#include "profiler.hpp"
+#include "random.hpp"
+#include "replay.hpp"
 #include "debug_path.hpp"
 #include "debug_boundaries.hpp"
 #include "debug_collider.hpp"
@@ -14,11 +26,6 @@
 
 // stlib
 #include <vector>
-#include <random>
-
-#define SDL_MAIN_HANDLED
-#include <SDL.h>
-#include <SDL_mixer.h>
 
 // Container for all our entities and game logic. Individual rendering / update is 
 // deferred to the relative update() methods
@@ -29,7 +36,9 @@ public:
 	~World();
 
 	// Creates a window, sets up events and begins the game
-	bool init(vec2 screen);
+	// NullWindow and NullAudio run the game without a window, GL context or audio device,
+	// draw() then renders nothing
+	bool init(vec2 screen, Window& window, Audio& audio);
 
 	// Releases all associated resources
 	void destroy();
@@ -37,33 +46,46 @@ public:
 	// Steps the game ahead by ms milliseconds
 	bool update(float ms);
 
-	// Renders our scene
-	void draw();
+	// Renders our scene, alpha of the way from the previous update to the last one
+	void draw(float alpha);
 
 	// Should the game be over ?
 	bool is_over()const;
 
-private:
-	// Generates a new turtle
-	bool spawn_turtle();
+	// Fish eaten since the last reset
+	unsigned int get_points()const;
+
+	// Starts the random numbers over from seed, call before the first update(). The path planner
+	// is then waited on every update so the same input always plays out the same game.
+	void seed(uint32_t seed);
+
+	// Records the seed and the input of this game to path, call before the first update()
+	bool record(const char* path);
 
-	// Generates a new fish
-	bool spawn_fish();
+	// Plays the recording at path instead of listening to the window, call before the first
+	// update(). The game is over once all the recorded updates were played.
+	bool replay(const char* path);
 
+private:
 	// !!! INPUT CALLBACK FUNCTIONS
-	void on_key(GLFWwindow*, int key, int, int action, int mod);
-	void on_mouse_move(GLFWwindow* window, double xpos, double ypos);
+	void on_key(int key, int action, int mod);
+	void on_mouse_move(double xpos, double ypos);
 
 private:
 
     void reset_world();
-    void on_mouse_click(GLFWwindow* window, int key, int action, int mod);
 
-    bool load_default_sounds();
-    bool load_dope_sounds();
+    // Registers the salmon, turtles, fish and pebbles in the broadphase
+    void update_broadphase();
+    void on_mouse_click(int key, int action, int mod);
+
+    // Input from the window, recorded before it is handled and ignored during a replay
+    void on_window_key(int key, int action, int mod);
+    void on_window_mouse_click(int key, int action, int mod);
 
 	// Window handle
-	GLFWwindow* m_window;
+	Window* m_window;
+	Audio* m_audio;
 	float m_screen_scale; // Screen to pixel coordinates scale factor
 
 	// Screen texture
@@ -74,6 +96,38 @@ private:
 	// Water effect
 	Water m_water;
 
+	// Draws the turtles and fish, in one call as they share the atlas
+	SpriteBatch m_sprite_batch;
+
+	// Every skin of the turtles and fish, decoded once so that switching skins is free
+	TextureAtlas m_sprite_atlas;
+
+	// Textures, shaders and meshes shared by the entities
+	ResourceCache m_resources;
+
+	// Decodes the skins and sounds on worker threads. Declared after what it decodes into, so
+	// that it stops before those are gone.
+	AssetLoader m_assets;
+
+	// Phases of init(), and when the first frame and the last background asset came
+	StartupTimer m_startup;
+	bool m_first_frame_drawn;
+	bool m_assets_loaded;
+
+	// GPU time of the render passes, displayed in the window title
+	GpuTimer m_gpu_timer;
+
+	// Obstacles seen by the fish and turtle AI
+	NavGrid m_nav_grid;
+
+	// Plans the fish and turtle paths off the game thread
+	PathPlanner m_path_planner;
+
+	// Finds the entities close enough to collide, rebuilt every frame
+	SpatialHash m_broadphase;
+	std::vector<SpatialHash::Pair> m_collision_pairs;
+	std::vector<bool> m_eaten_fish;
+
 	DebugPath m_debug_path;
     DebugBoundaries m_debug_boundaries;
     DebugCollider m_debug_collider;
@@ -84,8 +138,8 @@ private:
 
 	// Game entities
 	Salmon m_salmon;
-	std::vector<Turtle> m_turtles;
-	std::vector<Fish> m_fish;
+	Turtles m_turtles;
+	FishSchool m_fish;
 	Pebbles m_pebbles_emitter;
 
 	float m_current_speed;
@@ -122,8 +176,9 @@ private:
     int m_base_turtle_delay;
     int m_mode3_turtle_delay;
 
-    int m_frame_skip;
+    int m_frame_skip; // ticks between two turtle paths
     int m_frame_count = 0;
+    unsigned int m_planned_nav_version = 0; // of the grid the last snapshot was taken from
 
     bool m_mode1; // m & n
     bool m_mode2; // k & l
@@ -133,11 +188,13 @@ private:
 	bool m_freeze;
     bool m_debugging;
 
-	Mix_Music* m_background_music;
-	Mix_Chunk* m_salmon_dead_sound;
-	Mix_Chunk* m_salmon_eat_sound;
+	// Draws every random number of the game
+	Random m_random;
+	bool m_deterministic;
 
-	// C++ rng
-	std::default_random_engine m_rng;
-	std::uniform_real_distribution<float> m_dist; // default 0..1
+	// Input recording and playback, m_tick counts the updates since init()
+	InputRecorder m_recorder;
+	InputPlayer m_player;
+	uint32_t m_tick;
+	float m_step_ms; // last step recorded or replayed
 };
@@ -0,0 +1,26 @@
+// Converts a text mesh to the binary format the game maps at startup, see mesh_file.hpp
+//
+// Usage: mesh_convert input.mesh output.smesh
+// The build runs it on data/meshes/salmon.mesh, run it by hand after editing another mesh.
+
+#include "mesh_file.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s input.mesh output.smesh\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Vertex> vertices;
+    std::vector<uint16_t> indices;
+    if (!read_text_mesh(argv[1], vertices, indices) || !write_mesh_file(argv[2], vertices, indices))
+        return EXIT_FAILURE;
+
+    MeshBounds bounds = compute_mesh_bounds(vertices.data(), vertices.size());
+    std::printf("%s: %zu vertices, %zu triangles, bounds (%g, %g) to (%g, %g)\n", argv[2],
+                vertices.size(), indices.size() / 3, bounds.min.x, bounds.min.y, bounds.max.x, bounds.max.y);
+    return EXIT_SUCCESS;
+}
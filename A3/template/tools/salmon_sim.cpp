@@ -0,0 +1,93 @@
+// Runs the game without a window, GL context or audio device, as fast as it can step
+//
+// Usage: salmon_sim [ticks] [ms per tick] [--seed n] [--replay file] [--trace file]
+// Defaults to 100000 ticks of 1000/60 ms from a fixed seed, so that two builds play the same game.
+// A replay runs to its end with the steps it was recorded with, ticks then only caps its length.
+// --trace saves the profiling zones of the last ticks when the run is over, see profiler.hpp.
+
+#include "world.hpp"
+#include "platform.hpp"
+#include "profiler.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+using Clock = std::chrono::high_resolution_clock;
+
+namespace
+{
+    const int DEFAULT_TICKS = 100000;
+    const float DEFAULT_TICK_MS = 1000.f / 60.f;
+    const uint32_t DEFAULT_SEED = 1;
+    const int WIDTH = 1200;
+    const int HEIGHT = 800;
+}
+
+// Global, the world is too large for the stack
+World world;
+NullWindow window;
+NullAudio audio;
+
+int main(int argc, char* argv[]) {
+    int ticks = -1;
+    float tick_ms = DEFAULT_TICK_MS;
+    uint32_t seed = DEFAULT_SEED;
+    const char* replay_path = nullptr;
+    const char* trace_path = nullptr;
+
+    int position = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = (uint32_t) std::strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            replay_path = argv[++i];
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            trace_path = argv[++i];
+        else if (position++ == 0)
+            ticks = std::atoi(argv[i]);
+        else
+            tick_ms = (float) std::atof(argv[i]);
+    }
+    if (ticks < 0)
+        ticks = replay_path != nullptr ? std::numeric_limits<int>::max() : DEFAULT_TICKS;
+
+    if (!world.init({ (float) WIDTH, (float) HEIGHT }, window, audio)) {
+        fprintf(stderr, "Failed to initialize the world\n");
+        return EXIT_FAILURE;
+    }
+
+    if (replay_path != nullptr) {
+        if (!world.replay(replay_path))
+            return EXIT_FAILURE;
+    } else {
+        world.seed(seed);
+    }
+
+    Profiler::set_thread_name("game");
+
+    auto start = Clock::now();
+    int tick = 0;
+    bool failed = false;
+    for (; tick < ticks && !world.is_over(); ++tick) {
+        if (!world.update(tick_ms)) {
+            fprintf(stderr, "World update failed at tick %d\n", tick);
+            failed = true;
+            break;
+        }
+    }
+    double elapsed_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::printf("%d ticks in %.1f ms\n", tick, elapsed_ms);
+    std::printf("%.0f ticks/s, %.3f ms/tick\n", tick / (elapsed_ms / 1000.0), elapsed_ms / tick);
+    std::printf("points: %u\n", world.get_points());
+
+    if (trace_path != nullptr && !Profiler::save_trace(trace_path))
+        failed = true;
+
+    world.destroy();
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}